@@ -0,0 +1,305 @@
+// Per-stage microbenchmarks of goofySimdEncode
+//
+// Every stage of the encoder pipeline is timed separately on L1-resident synthetic data (64x16 pixels = 4 KB).
+// Stages read their inputs from (and write their outputs to) a small per-strip buffer, so the reported numbers
+// include one L1 load/store round trip per stage; the sum of all stages is slightly higher than the full encoder.
+//
+// Numbers are TSC ticks per 4x4 block (reference cycles, not core cycles if the CPU runs at a different clock) and ns per block.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../GoofyTC/goofy_tc.h"
+
+#if defined(_MSC_VER)
+#define BENCH_CLOBBER_MEMORY() _ReadWriteBarrier()
+#else
+#define BENCH_CLOBBER_MEMORY() asm volatile("" ::: "memory")
+#endif
+
+using namespace goofy;
+
+static const unsigned int kWidth = 64;
+static const unsigned int kHeight = 16;
+static const unsigned int kStride = kWidth * 4;
+static const unsigned int kNumberOfStrips = (kWidth / 16) * (kHeight / 4);
+static const unsigned int kNumberOfBlocks = kNumberOfStrips * 4;
+static const unsigned int kNumberOfPasses = 20000;
+static const unsigned int kNumberOfMeasurements = 15;
+
+// Inputs/outputs of the pipeline stages for one 16x4 strip (4 blocks)
+struct StripData
+{
+    const unsigned char* pixels;
+    uint8x16x4_t bl[4];
+    uint8x16x4_t blMin;
+    uint8x16x4_t blMax;
+    uint8x16_t minColors;
+    uint8x16_t maxColors;
+    uint8x16_t blRangeY;
+    uint8x16_t blMidY;
+    uint8x16_t blQThreshold;
+    uint8x16_t blY[4];
+    uint8x16_t blGezMask[4];
+    uint8x16_t blLqtMask[4];
+    uint32_t result[8];
+};
+
+static uint64_t readCycleCounter()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Fetch 16x4 pixels
+static inline void stageFetch(StripData& d)
+{
+    const unsigned char* p = d.pixels;
+    for (int i = 0; i < 4; i++)
+    {
+        d.bl[i].r0 = simd::fetch(p + i * 16);
+        d.bl[i].r1 = simd::fetch(p + kStride + i * 16);
+        d.bl[i].r2 = simd::fetch(p + kStride * 2 + i * 16);
+        d.bl[i].r3 = simd::fetch(p + kStride * 3 + i * 16);
+    }
+}
+
+// Per column min/max (vertical reduction)
+static inline void stageMinMax(StripData& d)
+{
+    d.blMin.r0 = simd::minu(simd::minu(d.bl[0].r0, d.bl[0].r1), simd::minu(d.bl[0].r2, d.bl[0].r3));
+    d.blMin.r1 = simd::minu(simd::minu(d.bl[1].r0, d.bl[1].r1), simd::minu(d.bl[1].r2, d.bl[1].r3));
+    d.blMin.r2 = simd::minu(simd::minu(d.bl[2].r0, d.bl[2].r1), simd::minu(d.bl[2].r2, d.bl[2].r3));
+    d.blMin.r3 = simd::minu(simd::minu(d.bl[3].r0, d.bl[3].r1), simd::minu(d.bl[3].r2, d.bl[3].r3));
+    d.blMax.r0 = simd::maxu(simd::maxu(d.bl[0].r0, d.bl[0].r1), simd::maxu(d.bl[0].r2, d.bl[0].r3));
+    d.blMax.r1 = simd::maxu(simd::maxu(d.bl[1].r0, d.bl[1].r1), simd::maxu(d.bl[1].r2, d.bl[1].r3));
+    d.blMax.r2 = simd::maxu(simd::maxu(d.bl[2].r0, d.bl[2].r1), simd::maxu(d.bl[2].r2, d.bl[2].r3));
+    d.blMax.r3 = simd::maxu(simd::maxu(d.bl[3].r0, d.bl[3].r1), simd::maxu(d.bl[3].r2, d.bl[3].r3));
+}
+
+// transposeAs4x4 + horizontal reduction (per block min/max colors)
+static inline void stageTranspose(StripData& d)
+{
+    const uint8x16x4_t blMinTr = simd::transposeAs4x4(d.blMin);
+    d.minColors = simd::minu(simd::minu(blMinTr.r0, blMinTr.r1), simd::minu(blMinTr.r2, blMinTr.r3));
+    const uint8x16x4_t blMaxTr = simd::transposeAs4x4(d.blMax);
+    d.maxColors = simd::maxu(simd::maxu(blMaxTr.r0, blMaxTr.r1), simd::maxu(blMaxTr.r2, blMaxTr.r3));
+}
+
+// deinterleaveRGB + Y (block min/max brightness, range, thresholds and per pixel brightness)
+static inline void stageBrightness(StripData& d)
+{
+    const uint8x16x4_t blMinMax = simd::zipU4x2(d.minColors, d.minColors, d.maxColors, d.maxColors);
+    const uint8x16x3_t blMinMaxDi = simd::deinterleaveRGB(blMinMax);
+    const uint8x16_t Y = simd::avg(simd::avg(blMinMaxDi.r0, blMinMaxDi.r2), blMinMaxDi.r1);
+    const uint8x16x2_t blMinMaxY = simd::zipB16(Y, Y);
+
+    const uint8x16_t constZero = simd::zero();
+    d.blRangeY = simd::maxu(simd::subsatu(blMinMaxY.r1, blMinMaxY.r0), simd::fetch(&gConstEight));
+    d.blMidY = simd::avg(blMinMaxY.r0, blMinMaxY.r1);
+    const uint8x16_t blHalfRangeY = simd::avg(d.blRangeY, constZero);
+    const uint8x16_t blQuarterRangeY = simd::avg(blHalfRangeY, constZero);
+    const uint8x16_t blEighthsRangeY = simd::avg(blQuarterRangeY, constZero);
+    d.blQThreshold = simd::addsatu(blQuarterRangeY, blEighthsRangeY);
+
+    for (int i = 0; i < 4; i++)
+    {
+        const uint8x16x3_t blDi = simd::deinterleaveRGB(d.bl[i]);
+        d.blY[i] = simd::avg(simd::avg(blDi.r0, blDi.r2), blDi.r1);
+    }
+}
+
+static inline void getMasks(const uint8x16_t& blY, const uint8x16_t& blMidY, const uint8x16_t& blQThreshold, const uint8x16_t& constMaxInt, uint8x16_t& gezMask,
+                            uint8x16_t& lqtMask)
+{
+    const uint8x16_t posDiffY = simd::minu(simd::subsatu(blY, blMidY), constMaxInt);
+    const uint8x16_t negDiffY = simd::minu(simd::subsatu(blMidY, blY), constMaxInt);
+    gezMask = simd::cmpeqi(negDiffY, simd::zero());
+    lqtMask = simd::cmplti(simd::bit_or(posDiffY, negDiffY), blQThreshold);
+}
+
+// Threshold masks (GreaterEqualZero and LessThanQuantizationThreshold)
+static inline void stageMasks(StripData& d)
+{
+    const uint8x16_t constMaxInt = simd::fetch(&gConstMaxInt);
+    getMasks(d.blY[0], simd::replicateU0000(d.blMidY), simd::replicateU0000(d.blQThreshold), constMaxInt, d.blGezMask[0], d.blLqtMask[0]);
+    getMasks(d.blY[1], simd::replicateU1111(d.blMidY), simd::replicateU1111(d.blQThreshold), constMaxInt, d.blGezMask[1], d.blLqtMask[1]);
+    getMasks(d.blY[2], simd::replicateU2222(d.blMidY), simd::replicateU2222(d.blQThreshold), constMaxInt, d.blGezMask[2], d.blLqtMask[2]);
+    getMasks(d.blY[3], simd::replicateU3333(d.blMidY), simd::replicateU3333(d.blQThreshold), constMaxInt, d.blGezMask[3], d.blLqtMask[3]);
+}
+
+// DXT1 indices and rgb565 end points
+static inline void stageFinalizeDXT1(StripData& d)
+{
+    const uint8x16_t maxColors555 = convertRgb888ToRgb555(d.maxColors);
+    const uint8x16_t minColors555 = convertRgb888ToRgb555(d.minColors);
+    const uint8x16x2_t maxMinColors555 = simd::zipU4(maxColors555, minColors555);
+    const uint64x2_t maxMin01 = simd::getAsUInt64x2(maxMinColors555.r0);
+    const uint64x2_t maxMin23 = simd::getAsUInt64x2(maxMinColors555.r1);
+    const uint64_t maxMin[4] = {maxMin01.r0, maxMin01.r1, maxMin23.r0, maxMin23.r1};
+    for (int i = 0; i < 4; i++)
+    {
+        const uint8x16x2_t rawIndices = simd::zipB16(simd::bitnot(d.blGezMask[i]), d.blLqtMask[i]);
+        d.result[i * 2 + 0] = packDXT1Colors555(maxMin[i]);
+        d.result[i * 2 + 1] = simd::moveMaskMSB(rawIndices.r0) | (simd::moveMaskMSB(rawIndices.r1) << 16);
+    }
+}
+
+// ETC1 indices, base colors (average color with corrected brightness) and tables
+static inline void stageFinalizeETC1(StripData& d)
+{
+    const uint8x16_t constMaxInt = simd::fetch(&gConstMaxInt);
+    const uint8x16_t constZero = simd::zero();
+    const uint8x16x4_t blMasks = {simd::bit_or(simd::andnot(constMaxInt, d.blGezMask[0]), simd::bit_and(d.blLqtMask[0], constMaxInt)),
+                                  simd::bit_or(simd::andnot(constMaxInt, d.blGezMask[1]), simd::bit_and(d.blLqtMask[1], constMaxInt)),
+                                  simd::bit_or(simd::andnot(constMaxInt, d.blGezMask[2]), simd::bit_and(d.blLqtMask[2], constMaxInt)),
+                                  simd::bit_or(simd::andnot(constMaxInt, d.blGezMask[3]), simd::bit_and(d.blLqtMask[3], constMaxInt))};
+    const uint8x16x4_t blMasksTr = simd::transposeAs4x4x4(blMasks);
+    const uint8x16_t masksTr[4] = {blMasksTr.r0, blMasksTr.r1, blMasksTr.r2, blMasksTr.r3};
+
+    const uint8x16x4_t blAvg = {simd::avg(simd::avg(d.bl[0].r0, d.bl[0].r1), simd::avg(d.bl[0].r2, d.bl[0].r3)),
+                                simd::avg(simd::avg(d.bl[1].r0, d.bl[1].r1), simd::avg(d.bl[1].r2, d.bl[1].r3)),
+                                simd::avg(simd::avg(d.bl[2].r0, d.bl[2].r1), simd::avg(d.bl[2].r2, d.bl[2].r3)),
+                                simd::avg(simd::avg(d.bl[3].r0, d.bl[3].r1), simd::avg(d.bl[3].r2, d.bl[3].r3))};
+    const uint8x16x4_t blAvgTr = simd::transposeAs4x4(blAvg);
+    const uint8x16_t blAvgColors = simd::avg(simd::avg(blAvgTr.r0, blAvgTr.r1), simd::avg(blAvgTr.r2, blAvgTr.r3));
+    const uint8x16x4_t blAvg4 = simd::zipU4x2(blAvgColors, blAvgColors, blAvgColors, blAvgColors);
+    const uint8x16x3_t blAvg4Di = simd::deinterleaveRGB(blAvg4);
+    const uint8x16_t Y = simd::avg(simd::avg(blAvg4Di.r0, blAvg4Di.r2), blAvg4Di.r1);
+    const uint8x16x2_t blAvgY = simd::zipB16(Y, Y);
+
+    const uint8x16_t blPosCorrectionY = simd::minu(simd::subsatu(d.blMidY, blAvgY.r0), constMaxInt);
+    const uint8x16_t blNegCorrectionY = simd::minu(simd::subsatu(blAvgY.r0, d.blMidY), constMaxInt);
+    const uint8x16_t blCorrectionYGezMask = simd::cmpeqi(blNegCorrectionY, constZero);
+    const uint8x16_t blCorrectionYAbs = simd::bit_or(blPosCorrectionY, blNegCorrectionY);
+    const uint8x16_t blBaseColors = simd::select(blCorrectionYGezMask, simd::addsatu(blAvgColors, blCorrectionYAbs), simd::subsatu(blAvgColors, blCorrectionYAbs));
+    const uint64x2_t baseColors = simd::getAsUInt64x2(convertRgb888ToRgb555(blBaseColors));
+
+    const uint32_t base555[4] = {uint32_t((baseColors.r0 << 3ull) & 0xFFFFFF), uint32_t((baseColors.r0 >> 29ull) & 0xFFFFFF), uint32_t((baseColors.r1 << 3ull) & 0xFFFFFF),
+                                 uint32_t((baseColors.r1 >> 29ull) & 0xFFFFFF)};
+    const uint32_t range[4] = {vector_get_by_index<0>(d.blRangeY), vector_get_by_index<4>(d.blRangeY), vector_get_by_index<8>(d.blRangeY),
+                               vector_get_by_index<12>(d.blRangeY)};
+    for (int i = 0; i < 4; i++)
+    {
+        const uint32_t posOrZero = simd::moveMaskMSB(masksTr[i]);
+        uint8x16_t lessThanQtMask = simd::bit_and(masksTr[i], constMaxInt);
+        lessThanQtMask = simd::addsatu(lessThanQtMask, lessThanQtMask);
+        d.result[i * 2 + 0] = etc1BrighnessRangeTocontrolByte[range[i]] | base555[i];
+        d.result[i * 2 + 1] = ~(posOrZero | (simd::moveMaskMSB(lessThanQtMask) << 16));
+    }
+}
+
+struct StageTiming
+{
+    double ticksPerBlock;
+    double nsPerBlock;
+};
+
+// median of kNumberOfMeasurements runs (kNumberOfPasses over all strips each)
+template<typename Func> static StageTiming measure(std::vector<StripData>& strips, const Func& func)
+{
+    std::vector<double> ticks;
+    std::vector<double> ns;
+    for (unsigned int m = 0; m < kNumberOfMeasurements; m++)
+    {
+        const auto startingTime = std::chrono::steady_clock::now();
+        const uint64_t startingTicks = readCycleCounter();
+        for (unsigned int pass = 0; pass < kNumberOfPasses; pass++)
+        {
+            for (StripData& d : strips)
+            {
+                func(d);
+            }
+            BENCH_CLOBBER_MEMORY();
+        }
+        const uint64_t endingTicks = readCycleCounter();
+        const auto endingTime = std::chrono::steady_clock::now();
+
+        const double numberOfBlocks = double(kNumberOfPasses) * double(kNumberOfBlocks);
+        ticks.push_back(double(endingTicks - startingTicks) / numberOfBlocks);
+        ns.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(endingTime - startingTime).count()) / numberOfBlocks);
+    }
+
+    std::sort(ticks.begin(), ticks.end());
+    std::sort(ns.begin(), ns.end());
+    StageTiming res;
+    res.ticksPerBlock = ticks[ticks.size() / 2];
+    res.nsPerBlock = ns[ns.size() / 2];
+    return res;
+}
+
+static void printTiming(const char* stageName, const StageTiming& timing)
+{
+    printf("%-28s %8.2f %8.3f\n", stageName, timing.ticksPerBlock, timing.nsPerBlock);
+}
+
+int main()
+{
+    // synthetic content: gradients + noise (non flat blocks, all the code paths are used)
+    std::vector<unsigned char> image(size_t(kStride) * kHeight + 64);
+    unsigned char* pixels = image.data() + ((64 - (uintptr_t(image.data()) & 63)) & 63);
+    uint32_t seed = 0x12345678;
+    for (unsigned int y = 0; y < kHeight; y++)
+    {
+        for (unsigned int x = 0; x < kWidth; x++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            unsigned char* p = pixels + y * kStride + x * 4;
+            p[0] = (unsigned char)(x * 4 + ((seed >> 24) & 15));
+            p[1] = (unsigned char)(y * 16 + ((seed >> 16) & 31));
+            p[2] = (unsigned char)((x * y) + ((seed >> 8) & 7));
+            p[3] = 255;
+        }
+    }
+
+    std::vector<StripData> strips(kNumberOfStrips);
+    for (unsigned int i = 0; i < kNumberOfStrips; i++)
+    {
+        strips[i].pixels = pixels + (i / (kWidth / 16)) * kStride * 4 + (i % (kWidth / 16)) * 64;
+    }
+
+    // stages produce the same blocks as the encoder
+    bool isSameDXT1 = true;
+    bool isSameETC1 = true;
+    for (StripData& d : strips)
+    {
+        uint32_t expected[8];
+        stageFetch(d);
+        stageMinMax(d);
+        stageTranspose(d);
+        stageBrightness(d);
+        stageMasks(d);
+        stageFinalizeDXT1(d);
+        goofySimdEncode<GOOFY_DXT1>(d.pixels, kStride, (unsigned char*)expected);
+        isSameDXT1 = isSameDXT1 && (memcmp(expected, d.result, sizeof(expected)) == 0);
+        stageFinalizeETC1(d);
+        goofySimdEncode<GOOFY_ETC1>(d.pixels, kStride, (unsigned char*)expected);
+        isSameETC1 = isSameETC1 && (memcmp(expected, d.result, sizeof(expected)) == 0);
+    }
+    printf("Stages match the encoder: DXT1 %s, ETC1 %s\n", isSameDXT1 ? "yes" : "no", isSameETC1 ? "yes" : "no");
+    printf("%d blocks (%d bytes of pixels), %d passes, median of %d runs\n\n", kNumberOfBlocks, kStride * kHeight, kNumberOfPasses, kNumberOfMeasurements);
+
+    printf("%-28s %8s %8s\n", "Stage", "tsc/blk", "ns/blk");
+    printTiming("fetch", measure(strips, [](StripData& d) { stageFetch(d); }));
+    printTiming("min/max reduction", measure(strips, [](StripData& d) { stageMinMax(d); }));
+    printTiming("transposeAs4x4 + reduction", measure(strips, [](StripData& d) { stageTranspose(d); }));
+    printTiming("deinterleaveRGB + Y", measure(strips, [](StripData& d) { stageBrightness(d); }));
+    printTiming("masks", measure(strips, [](StripData& d) { stageMasks(d); }));
+    printTiming("finalize DXT1", measure(strips, [](StripData& d) { stageFinalizeDXT1(d); }));
+    printTiming("finalize ETC1", measure(strips, [](StripData& d) { stageFinalizeETC1(d); }));
+    printTiming("goofySimdEncode DXT1", measure(strips, [](StripData& d) { goofySimdEncode<GOOFY_DXT1>(d.pixels, kStride, (unsigned char*)d.result); }));
+    printTiming("goofySimdEncode ETC1", measure(strips, [](StripData& d) { goofySimdEncode<GOOFY_ETC1>(d.pixels, kStride, (unsigned char*)d.result); }));
+    return (isSameDXT1 && isSameETC1) ? 0 : 1;
+}
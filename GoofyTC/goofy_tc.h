@@ -10,6 +10,134 @@
 namespace goofy {
 int compressDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride);
 int compressETC1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride);
+
+// Same as above, but also output estimated per-block error (sum of squared brightness errors of 16 pixels)
+// errorMap is (width / 4) x (height / 4) values, row by row
+int compressDXT1WithErrorMap(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap);
+int compressETC1WithErrorMap(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap);
+
+// Encoder content statistics: how often the encoder clamps (content where the quality degrades)
+struct EncoderStats
+{
+    uint64_t numBlocks;
+    uint64_t numFlatBlocks;         // solid color blocks (min color == max color)
+    uint64_t numRangeClampedBlocks; // brightness range < 8 (floored to 8)
+    uint64_t numClampedPixels;      // |brightness - block mid brightness| > 127 (clamped to 127)
+    uint64_t numEtcTableBlocks[8];  // ETC1 only: number of blocks per modifier table
+};
+
+// Same as compressDXT1/compressETC1, but also accumulate encoder statistics (set stats to zero before the first call)
+int compressDXT1WithStats(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, EncoderStats* stats);
+int compressETC1WithStats(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, EncoderStats* stats);
+
+// Encode only blocks touched by the region (x, y, w, h in pixels) and write them into an existing compressed image
+// The region is snapped out to 4x4 block boundaries (image size must be a multiple of 4)
+// dst/src point to the whole compressed/source image (width x height pixels), dstPitch = distance between rows of blocks in bytes
+// returns -3 if the region is not inside of the image (nothing is written)
+int compressRegionDXT1(unsigned char* dst, unsigned int dstPitch, const unsigned char* src, unsigned int srcStride, unsigned int width, unsigned int height, unsigned int x,
+                       unsigned int y, unsigned int w, unsigned int h);
+int compressRegionETC1(unsigned char* dst, unsigned int dstPitch, const unsigned char* src, unsigned int srcStride, unsigned int width, unsigned int height, unsigned int x,
+                       unsigned int y, unsigned int w, unsigned int h);
+
+// Temporal mode (video, live-sync): 16x4 pixel strips that did not change since the previous frame are skipped
+// result must hold the blocks of the previous frame, stripHashes ((width / 16) * (height / 4) values) keep the state
+// between frames (set to zero to encode every strip), changedStrips receives a bitmap of re-encoded strips (bit per strip, row by row)
+// returns the number of re-encoded strips (or negative value on error)
+int compressDXT1Temporal(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips);
+int compressETC1Temporal(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips);
+
+// Deduplication mode (atlases, tile maps): results of repeated 4x4 blocks are copied from a small cache instead of encoding
+// The cache can be kept between calls to reuse blocks across images (it is cleared on DXT1/ETC1 switch)
+struct BlockCache;
+BlockCache* createBlockCache();
+void destroyBlockCache(BlockCache* cache);
+// Number of block lookups and hits since the cache was created
+// Only hits that skipped encoding are counted: the encoder works on 16x4 strips, so a strip is taken from the cache
+// if all of its 4 blocks are cached, otherwise the whole strip is encoded (and its cached blocks don't count as hits)
+void getBlockCacheStats(const BlockCache* cache, uint64_t* numLookups, uint64_t* numHits);
+int compressDXT1Dedup(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, BlockCache* cache);
+int compressETC1Dedup(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, BlockCache* cache);
+
+// Single block encoder: 4x4 RGBA pixels (16 bytes per line) to 8 bytes
+typedef void (*EncodeBlockFunc)(unsigned char* result, const unsigned char* rgba, void* userData);
+
+// Hybrid mode: encode with Goofy, then re-encode blocks with the largest estimated error using given (slow but high quality) block encoder
+// errorThreshold - re-encode blocks with estimated error >= threshold
+// worstBlocksPercent - if non zero, re-encode given percent of the worst blocks instead (errorThreshold is ignored)
+// errorMap - (width / 4) x (height / 4) values, receives the Goofy per-block errors
+// returns the number of re-encoded blocks (or negative value on error)
+int compressDXT1Hybrid(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap,
+                       EncodeBlockFunc encodeBlock, void* userData, uint32_t errorThreshold, unsigned int worstBlocksPercent);
+int compressETC1Hybrid(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap,
+                       EncodeBlockFunc encodeBlock, void* userData, uint32_t errorThreshold, unsigned int worstBlocksPercent);
+
+// Convert ETC1s blocks (e.g. produced by compressETC1) to DXT1 blocks without decoding to RGBA
+int transcodeETC1sToDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height);
+
+// Convert DXT1 blocks to ETC1s blocks without decoding to RGBA
+int transcodeDXT1ToETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height);
+
+// Build the next mip level (width / 2 x height / 2) straight from DXT1/ETC1s blocks without decoding to RGBA
+// Every output block is made from 2x2 input blocks, width/height are the input level dimensions (must be a multiple of 8)
+int generateMipDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height);
+int generateMipETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height);
+
+// Lossless compressed-domain transforms (blocks and pixel indices are permuted, colors are untouched)
+enum GoofyTransform
+{
+    GOOFY_FLIP_X,        // mirror left-right
+    GOOFY_FLIP_Y,        // mirror top-bottom
+    GOOFY_ROTATE_90_CW,  // result is height x width
+    GOOFY_ROTATE_180,
+    GOOFY_ROTATE_90_CCW, // result is height x width
+};
+
+// width/height are the input image dimensions, result must not overlap input
+int transformDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, GoofyTransform transform);
+int transformETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, GoofyTransform transform);
+
+// Copy a block aligned rectangle between two DXT1/ETC1 images (crop, blit, atlas packing)
+// All coordinates and sizes are in pixels (must be a multiple of 4), the rectangle must be inside both images
+int copyBlocks(unsigned char* dst, unsigned int dstWidth, unsigned int dstX, unsigned int dstY, const unsigned char* src, unsigned int srcWidth, unsigned int srcX,
+               unsigned int srcY, unsigned int width, unsigned int height);
+
+// Tint/brightness adjustment of ETC1s blocks without re-encoding (only the base colors are changed, indices are untouched)
+// base = base * scale / 256 + offset (per channel, saturated), scale = 0..1024 (256 = no change), offset = -255..255
+// result can be the same as input
+int adjustColorETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, const unsigned int scaleRGB[3], const int offsetRGB[3]);
+
+// Image statistics computed straight from DXT1/ETC1s blocks without decoding (8 bytes are read per 16 pixels)
+// Colors of the block palette (endpoints or base color + intensity table) are weighted by selector population counts
+struct ImageStats
+{
+    // sum of rgb over all pixels, mean color = sum / (width * height)
+    uint64_t sumRGB[3];
+    // brightness histogram (16 bins of 16 levels, brightness = avg(avg(r, b), g)), in pixels
+    uint32_t histogram[16];
+};
+
+// tileMinMax (optional) receives two rgb888 values per tile of tileSizeInBlocks x tileSizeInBlocks blocks (tiles row by row, partial tiles at the edges):
+// per channel min and max of the colors used by the pixels of the tile
+int getStatsDXT1(const unsigned char* input, unsigned int width, unsigned int height, ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax);
+int getStatsETC1s(const unsigned char* input, unsigned int width, unsigned int height, ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax);
+
+#ifdef GOOFY_PROFILE
+// Encoder profiling (GOOFY_PROFILE builds only): TSC ticks spent by the calling thread in the encoder stages
+// NOTE: rdtsc is not serializing, out-of-order execution blurs the stage boundaries a bit
+struct ProfileCounters
+{
+    uint64_t fetchTicks;    // fetch 16x4 pixels (+ strip hash in temporal mode)
+    uint64_t minMaxTicks;   // min/max block colors
+    uint64_t quantizeTicks; // brightness, thresholds and index masks
+    uint64_t errorTicks;    // per-block error estimation (error map and hybrid modes)
+    uint64_t finalizeTicks; // DXT1/ETC1 blocks packing
+    uint64_t imageTicks;    // compressDXT1/compressETC1 calls (outer loops included)
+    uint64_t numStrips;     // encoded 16x4 strips (4 blocks)
+    uint64_t numImages;     // compressDXT1/compressETC1 calls
+};
+ProfileCounters getProfileCounters();
+void resetProfileCounters();
+#endif
 } // namespace goofy
 
 // Enable SSE2 codec
@@ -31,6 +159,16 @@ int compressETC1(unsigned char* result, const unsigned char* input, unsigned int
 #include <cstring> // memset/memcpy
 #endif
 
+#ifdef GOOFY_PROFILE
+#if defined(_MSC_VER)
+#include <intrin.h> // __rdtsc
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#else
+#include <chrono>
+#endif
+#endif
+
 #define GOOFYTC_IMPLEMENTATION
 
 #ifdef GOOFYTC_IMPLEMENTATION
@@ -39,8 +177,36 @@ namespace goofy
 
 // constants
 goofy_align16(static const uint32_t gConstEight[4]) = { 0x08080808, 0x08080808, 0x08080808, 0x08080808 };
+goofy_align16(static const uint32_t gConstFour[4]) = { 0x04040404, 0x04040404, 0x04040404, 0x04040404 };
 goofy_align16(static const uint32_t gConstSixteen[4]) = { 0x10101010, 0x10101010, 0x10101010, 0x10101010 };
 goofy_align16(static const uint32_t gConstMaxInt[4]) = { 0x7f7f7f7f, 0x7f7f7f7f, 0x7f7f7f7f, 0x7f7f7f7f };
+goofy_align16(static const uint32_t gConstSignBits[4]) = { 0x80808080, 0x80808080, 0x80808080, 0x80808080 };
+goofy_align16(static const uint32_t gConstAlphaMask[4]) = { 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000 };
+goofy_align16(static const uint32_t gConstBitSelect[4]) = { 0x08040201, 0x80402010, 0x08040201, 0x80402010 };
+goofy_align16(static const uint32_t gConstHashMul[4]) = { 0x85EBCA77, 0x0, 0x85EBCA77, 0x0 };
+goofy_align16(static const uint32_t gConstHashLinear[16]) = { 0x9E3779B1, 0x85EBCA77, 0xC2B2AE3D, 0x27D4EB2F, 0x165667B1, 0xD3A2646C, 0xFD7046C5, 0xB55A4F09,
+                                                             0x7FEB352D, 0x846CA68B, 0x68E31DA4, 0xB5297A4D, 0x1B873593, 0xCC9E2D51, 0xE6546B64, 0x94D049BB };
+goofy_align16(static const uint32_t gConstEvenBits[4]) = { 0x55555555, 0x55555555, 0x55555555, 0x55555555 };
+goofy_align16(static const uint32_t gConstLowHalf[4]) = { 0x0000FFFF, 0x0000FFFF, 0x0000FFFF, 0x0000FFFF };
+goofy_align16(static const uint32_t gConstEtcBaseColorMask[4]) = { 0x00f8f8f8, 0x00f8f8f8, 0x00f8f8f8, 0x00f8f8f8 };
+// 16-bit lanes (compressed-domain mip kernels)
+goofy_align16(static const uint32_t gConstWordOne[4]) = { 0x00010001, 0x00010001, 0x00010001, 0x00010001 };
+goofy_align16(static const uint32_t gConstWordTwo[4]) = { 0x00020002, 0x00020002, 0x00020002, 0x00020002 };
+goofy_align16(static const uint32_t gConstWordThree[4]) = { 0x00030003, 0x00030003, 0x00030003, 0x00030003 };
+goofy_align16(static const uint32_t gConstWordFour[4]) = { 0x00040004, 0x00040004, 0x00040004, 0x00040004 };
+goofy_align16(static const uint32_t gConstWordSix[4]) = { 0x00060006, 0x00060006, 0x00060006, 0x00060006 };
+goofy_align16(static const uint32_t gConstWordEight[4]) = { 0x00080008, 0x00080008, 0x00080008, 0x00080008 };
+goofy_align16(static const uint32_t gConstWordNine[4]) = { 0x00090009, 0x00090009, 0x00090009, 0x00090009 };
+goofy_align16(static const uint32_t gConstWordOneThird[4]) = { 0x55565556, 0x55565556, 0x55565556, 0x55565556 };
+goofy_align16(static const uint32_t gConstWordTwelve[4]) = { 0x000C000C, 0x000C000C, 0x000C000C, 0x000C000C };
+goofy_align16(static const uint32_t gConstWordNibble[4]) = { 0x000F000F, 0x000F000F, 0x000F000F, 0x000F000F };
+goofy_align16(static const uint32_t gConstWord5Bits[4]) = { 0x001F001F, 0x001F001F, 0x001F001F, 0x001F001F };
+goofy_align16(static const uint32_t gConstWord6Bits[4]) = { 0x003F003F, 0x003F003F, 0x003F003F, 0x003F003F };
+goofy_align16(static const uint32_t gConstWordLowByte[4]) = { 0x00FF00FF, 0x00FF00FF, 0x00FF00FF, 0x00FF00FF };
+goofy_align16(static const uint32_t gConstWordMaxY4[4]) = { 0x03FC03FC, 0x03FC03FC, 0x03FC03FC, 0x03FC03FC };
+goofy_align16(static const uint32_t gConstWordSign[4]) = { 0x80008000, 0x80008000, 0x80008000, 0x80008000 };
+goofy_align16(static const uint32_t gConstWordBitPairs[4]) = { 0x33333333, 0x33333333, 0x33333333, 0x33333333 };
+goofy_align16(static const uint32_t gConstWordNibbles[4]) = { 0x0F0F0F0F, 0x0F0F0F0F, 0x0F0F0F0F, 0x0F0F0F0F };
 
 #ifdef GOOFY_SSE2
 typedef __m128i uint8x16_t;
@@ -177,6 +343,11 @@ namespace simd
         return _mm_load_si128((const __m128i*)p);
     }
 
+    goofy_inline uint8x16_t fetchUnaligned(const void* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+
     goofy_inline uint64x2_t getAsUInt64x2(const uint8x16_t& a)
     {
         uint64x2_t res;
@@ -260,6 +431,12 @@ namespace simd
         return _mm_subs_epu8(a, b);
     }
 
+    template<int N>
+    goofy_inline uint8x16_t shiftRight(const uint8x16_t& a)
+    {
+        return _mm_and_si128(_mm_srli_epi16(a, N), _mm_set1_epi8((char)(0xFF >> N)));
+    }
+
     goofy_inline uint8x16x4_t transposeAs4x4(const uint8x16x4_t& v)
     {
         uint8x16_t tr0 = _mm_unpacklo_epi32(v.r0, v.r1);
@@ -357,6 +534,44 @@ namespace simd
         return res;
     }
 
+    goofy_inline uint8x16x4_t transposeAs4x4x4Inverse(const uint8x16x4_t& v)
+    {
+        const uint8x16_t c0 = _mm_shuffle_epi32(v.r0, _MM_SHUFFLE(1, 0, 3, 2));
+        const uint8x16_t c1 = _mm_shuffle_epi32(v.r1, _MM_SHUFFLE(1, 0, 3, 2));
+        const uint8x16_t c2 = _mm_shuffle_epi32(v.r2, _MM_SHUFFLE(1, 0, 3, 2));
+        const uint8x16_t c3 = _mm_shuffle_epi32(v.r3, _MM_SHUFFLE(1, 0, 3, 2));
+
+        const uint8x16_t s0a = _mm_unpacklo_epi8(c0, c1);
+        const uint8x16_t s0b = _mm_unpackhi_epi8(c0, c1);
+        const uint8x16_t s0c = _mm_unpacklo_epi8(c2, c3);
+        const uint8x16_t s0d = _mm_unpackhi_epi8(c2, c3);
+        const uint8x16_t s1a = _mm_unpacklo_epi8(s0a, s0b);
+        const uint8x16_t s1b = _mm_unpackhi_epi8(s0a, s0b);
+        const uint8x16_t s1c = _mm_unpacklo_epi8(s0c, s0d);
+        const uint8x16_t s1d = _mm_unpackhi_epi8(s0c, s0d);
+        const uint8x16_t s2a = _mm_unpacklo_epi8(s1a, s1b);
+        const uint8x16_t s2b = _mm_unpackhi_epi8(s1a, s1b);
+        const uint8x16_t s2c = _mm_unpacklo_epi8(s1c, s1d);
+        const uint8x16_t s2d = _mm_unpackhi_epi8(s1c, s1d);
+
+        const uint8x16_t s3a = _mm_unpacklo_epi32(s2a, s2b);
+        const uint8x16_t s3b = _mm_unpackhi_epi32(s2a, s2b);
+        const uint8x16_t s3c = _mm_unpacklo_epi32(s2c, s2d);
+        const uint8x16_t s3d = _mm_unpackhi_epi32(s2c, s2d);
+
+        const uint8x16_t s4a = _mm_unpacklo_epi64(s3a, s3b);
+        const uint8x16_t s4b = _mm_unpackhi_epi64(s3a, s3b);
+        const uint8x16_t s4c = _mm_unpacklo_epi64(s3c, s3d);
+        const uint8x16_t s4d = _mm_unpackhi_epi64(s3c, s3d);
+
+        uint8x16x4_t res;
+        res.r0 = _mm_shuffle_epi32(s4a, _MM_SHUFFLE(3, 1, 2, 0));
+        res.r1 = _mm_shuffle_epi32(s4b, _MM_SHUFFLE(3, 1, 2, 0));
+        res.r2 = _mm_shuffle_epi32(s4c, _MM_SHUFFLE(3, 1, 2, 0));
+        res.r3 = _mm_shuffle_epi32(s4d, _MM_SHUFFLE(3, 1, 2, 0));
+        return res;
+    }
+
     goofy_inline uint8x16x4_t zipU4x2(const uint8x16_t& a, const uint8x16_t& b, const uint8x16_t& c, const uint8x16_t& d)
     {
         const uint8x16x4_t res = {
@@ -382,6 +597,16 @@ namespace simd
         return (uint32_t)_mm_movemask_epi8(v);
     }
 
+    goofy_inline uint8x16_t maskFromBits(uint32_t bits)
+    {
+        const uint8x16_t bitSelect = _mm_load_si128((const __m128i*)&gConstBitSelect);
+        uint8x16_t v = _mm_cvtsi32_si128((int)bits);
+        v = _mm_unpacklo_epi8(v, v);
+        v = _mm_unpacklo_epi16(v, v);
+        v = _mm_unpacklo_epi32(v, v);
+        return _mm_cmpeq_epi8(_mm_and_si128(v, bitSelect), bitSelect);
+    }
+
     goofy_inline uint8x16x2_t zipB16(const uint8x16_t& a, const uint8x16_t& b)
     {
         uint8x16x2_t res;
@@ -395,6 +620,175 @@ namespace simd
         return _mm_xor_si128(v, _mm_cmpeq_epi32(_mm_setzero_si128(), _mm_setzero_si128()));
     }
 
+    // res = min(a * scale >> 8, 255), scale = eight 16-bit values (used for both halves of a), max scale = 1024
+    goofy_inline uint8x16_t scaleU8(const uint8x16_t& a, const uint8x16_t& scale)
+    {
+        const uint8x16_t lo = _mm_mulhi_epu16(_mm_unpacklo_epi8(_mm_setzero_si128(), a), scale);
+        const uint8x16_t hi = _mm_mulhi_epu16(_mm_unpackhi_epi8(_mm_setzero_si128(), a), scale);
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    // Number of set bits in every 32-bit lane
+    goofy_inline uint8x16_t popcount32(const uint8x16_t& a)
+    {
+        uint8x16_t v = _mm_sub_epi32(a, _mm_and_si128(_mm_srli_epi32(a, 1), _mm_set1_epi32(0x55555555)));
+        v = _mm_add_epi32(_mm_and_si128(v, _mm_set1_epi32(0x33333333)), _mm_and_si128(_mm_srli_epi32(v, 2), _mm_set1_epi32(0x33333333)));
+        v = _mm_and_si128(_mm_add_epi32(v, _mm_srli_epi32(v, 4)), _mm_set1_epi32(0x0F0F0F0F));
+        v = _mm_add_epi32(v, _mm_srli_epi32(v, 8));
+        v = _mm_add_epi32(v, _mm_srli_epi32(v, 16));
+        return _mm_and_si128(v, _mm_set1_epi32(0x3F));
+    }
+
+    // Swap bit groups selected by MASK with the bits S positions higher (per 32-bit lane)
+    // t = ((x >> S) ^ x) & MASK; x = x ^ t ^ (t << S)
+    template<int S, uint32_t MASK>
+    goofy_inline uint8x16_t deltaSwap(const uint8x16_t& a)
+    {
+        const uint8x16_t t = _mm_and_si128(_mm_xor_si128(_mm_srli_epi32(a, S), a), _mm_set1_epi32((int)MASK));
+        return _mm_xor_si128(_mm_xor_si128(a, t), _mm_slli_epi32(t, S));
+    }
+
+    // res[i] = sum of squares of all 16 bytes of i-th vector
+    goofy_inline void storeSumOfSquaresX4(uint32_t* res, const uint8x16_t& a, const uint8x16_t& b, const uint8x16_t& c, const uint8x16_t& d)
+    {
+        const uint8x16_t z = _mm_setzero_si128();
+        const uint8x16_t a16lo = _mm_unpacklo_epi8(a, z);
+        const uint8x16_t a16hi = _mm_unpackhi_epi8(a, z);
+        const uint8x16_t b16lo = _mm_unpacklo_epi8(b, z);
+        const uint8x16_t b16hi = _mm_unpackhi_epi8(b, z);
+        const uint8x16_t c16lo = _mm_unpacklo_epi8(c, z);
+        const uint8x16_t c16hi = _mm_unpackhi_epi8(c, z);
+        const uint8x16_t d16lo = _mm_unpacklo_epi8(d, z);
+        const uint8x16_t d16hi = _mm_unpackhi_epi8(d, z);
+
+        // four partial sums per vector
+        const uint8x16_t sa = _mm_add_epi32(_mm_madd_epi16(a16lo, a16lo), _mm_madd_epi16(a16hi, a16hi));
+        const uint8x16_t sb = _mm_add_epi32(_mm_madd_epi16(b16lo, b16lo), _mm_madd_epi16(b16hi, b16hi));
+        const uint8x16_t sc = _mm_add_epi32(_mm_madd_epi16(c16lo, c16lo), _mm_madd_epi16(c16hi, c16hi));
+        const uint8x16_t sd = _mm_add_epi32(_mm_madd_epi16(d16lo, d16lo), _mm_madd_epi16(d16hi, d16hi));
+
+        // transpose and add
+        const uint8x16_t sab = _mm_add_epi32(_mm_unpacklo_epi32(sa, sb), _mm_unpackhi_epi32(sa, sb));
+        const uint8x16_t scd = _mm_add_epi32(_mm_unpacklo_epi32(sc, sd), _mm_unpackhi_epi32(sc, sd));
+        _mm_storeu_si128((__m128i*)res, _mm_add_epi32(_mm_unpacklo_epi64(sab, scd), _mm_unpackhi_epi64(sab, scd)));
+    }
+
+    // Cheap hash of 4x4 pixels (dot product of 16-bit words with constants), good enough for hash table index
+    goofy_inline uint32_t hashLinear(const uint8x16x4_t& bl)
+    {
+        const __m128i* k = (const __m128i*)&gConstHashLinear;
+        const uint8x16_t s01 = _mm_add_epi32(_mm_madd_epi16(bl.r0, _mm_load_si128(k + 0)), _mm_madd_epi16(bl.r1, _mm_load_si128(k + 1)));
+        const uint8x16_t s23 = _mm_add_epi32(_mm_madd_epi16(bl.r2, _mm_load_si128(k + 2)), _mm_madd_epi16(bl.r3, _mm_load_si128(k + 3)));
+        uint8x16_t sum = _mm_add_epi32(s01, s23);
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return (uint32_t)_mm_cvtsi128_si32(sum);
+    }
+
+    // Mix 16 bytes into two 64-bit hash lanes: x = (acc ^ v) * K, x ^= x >> 29
+    goofy_inline uint8x16_t hashMix(const uint8x16_t& acc, const uint8x16_t& v)
+    {
+        const uint8x16_t k = _mm_load_si128((const __m128i*)&gConstHashMul);
+        const uint8x16_t x = _mm_xor_si128(acc, v);
+        const uint8x16_t lo = _mm_mul_epu32(x, k);
+        const uint8x16_t hi = _mm_mul_epu32(_mm_srli_epi64(x, 32), k);
+        const uint8x16_t m = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+        return _mm_xor_si128(m, _mm_srli_epi64(m, 29));
+    }
+
+    goofy_inline uint8x16_t bit_xor(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_xor_si128(a, b);
+    }
+
+    // 16-bit lanes (wrap around)
+    goofy_inline uint8x16_t add16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_add_epi16(a, b);
+    }
+
+    goofy_inline uint8x16_t sub16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_sub_epi16(a, b);
+    }
+
+    goofy_inline uint8x16_t mullo16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_mullo_epi16(a, b);
+    }
+
+    // 16-bit lanes, (a * b) >> 16 (unsigned)
+    goofy_inline uint8x16_t mulhiu16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_mulhi_epu16(a, b);
+    }
+
+    // 16-bit lanes (signed) to 32-bit lanes: a0 * b0 + a1 * b1
+    goofy_inline uint8x16_t madd16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_madd_epi16(a, b);
+    }
+
+    // 32-bit lanes (wrap around)
+    goofy_inline uint8x16_t add32(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+
+    // 16-bit lanes (signed)
+    goofy_inline uint8x16_t min16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_min_epi16(a, b);
+    }
+
+    goofy_inline uint8x16_t max16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_max_epi16(a, b);
+    }
+
+    goofy_inline uint8x16_t cmplt16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_cmplt_epi16(a, b);
+    }
+
+    // 16-bit lanes (unsigned)
+    goofy_inline uint8x16_t avg16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_avg_epu16(a, b);
+    }
+
+    template<int N>
+    goofy_inline uint8x16_t shiftLeft16(const uint8x16_t& a)
+    {
+        return _mm_slli_epi16(a, N);
+    }
+
+    template<int N>
+    goofy_inline uint8x16_t shiftRight16(const uint8x16_t& a)
+    {
+        return _mm_srli_epi16(a, N);
+    }
+
+    // 16-bit lanes to bytes (signed saturate), a = lower 8 bytes, b = upper 8 bytes
+    goofy_inline uint8x16_t packs16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        return _mm_packs_epi16(a, b);
+    }
+
+    // swap 16-bit lanes inside every 32-bit lane
+    goofy_inline uint8x16_t swapPairs16(const uint8x16_t& a)
+    {
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    goofy_inline uint8x16x2_t zipU2(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint8x16x2_t res;
+        res.r0 = _mm_unpacklo_epi16(a, b);
+        res.r1 = _mm_unpackhi_epi16(a, b);
+        return res;
+    }
+
 #else
     // generic CPU implementation    
     namespace detail
@@ -537,6 +931,26 @@ namespace simd
             return res;
         }
 
+        goofy_inline uint8x16_t swizzleU2301(const uint8x16_t& a)
+        {
+            uint8x16_t res;
+            res.u0 = a.u2;
+            res.u1 = a.u3;
+            res.u2 = a.u0;
+            res.u3 = a.u1;
+            return res;
+        }
+
+        goofy_inline uint8x16_t swizzleU0213(const uint8x16_t& a)
+        {
+            uint8x16_t res;
+            res.u0 = a.u0;
+            res.u1 = a.u2;
+            res.u2 = a.u1;
+            res.u3 = a.u3;
+            return res;
+        }
+
     } //detail
 
     goofy_inline uint8x16_t zero()
@@ -553,6 +967,13 @@ namespace simd
         return r;
     }
 
+    goofy_inline uint8x16_t fetchUnaligned(const void* p)
+    {
+        uint8x16_t r;
+        memcpy(&r, p, sizeof(uint8x16_t));
+        return r;
+    }
+
     goofy_inline uint64x2_t getAsUInt64x2(const uint8x16_t& a)
     {
         uint64x2_t res;
@@ -604,6 +1025,17 @@ namespace simd
         return res;
     }
 
+    // inverse of moveMaskMSB (lower 16 bits to 0x00/0xFF bytes)
+    goofy_inline uint8x16_t maskFromBits(uint32_t bits)
+    {
+        uint8x16_t res;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            res.data[i] = ((bits >> i) & 1) ? 0xFF : 0x00;
+        }
+        return res;
+    }
+
     //
     // if (maskA) {
     //  return a;
@@ -743,6 +1175,18 @@ namespace simd
         return res;
     }
 
+    // per byte logical shift right
+    template<int N>
+    goofy_inline uint8x16_t shiftRight(const uint8x16_t& a)
+    {
+        uint8x16_t res;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            res.data[i] = (uint8_t)(a.data[i] >> N);
+        }
+        return res;
+    }
+
     // transpose as one 4x4 RGBA block
     //
     // in:
@@ -951,6 +1395,67 @@ namespace simd
         return res;
     }
 
+    // inverse of transposeAs4x4x4
+    //
+    // in:
+    //
+    // R0  = | bl0.cgko | bl0.dhlp | bl0.aeim | bl0.bfjn |
+    // R1  = | bl1.cgko | bl1.dhlp | bl1.aeim | bl1.bfjn |
+    // R2  = | bl2.cgko | bl2.dhlp | bl2.aeim | bl2.bfjn |
+    // R3  = | bl3.cgko | bl3.dhlp | bl3.aeim | bl3.bfjn |
+    //
+    // out:
+    //
+    // R0  = | bl0.abcd | bl0.efgh | bl0.ijkl | bl0.mnop |
+    // R1  = | bl1.abcd | bl1.efgh | bl1.ijkl | bl1.mnop |
+    // R2  = | bl2.abcd | bl2.efgh | bl2.ijkl | bl2.mnop |
+    // R3  = | bl3.abcd | bl3.efgh | bl3.ijkl | bl3.mnop |
+    //
+    goofy_inline uint8x16x4_t transposeAs4x4x4Inverse(const uint8x16x4_t& v)
+    {
+        // step 1 (swap columns back)
+
+        // | 0.a | 0.e | 0.i | 0.m | 0.b | 0.f | 0.j | 0.n | 0.c | 0.g | 0.k | 0.o | 0.d | 0.h | 0.l | 0.p |
+        const uint8x16_t c0 = detail::swizzleU2301(v.r0);
+        const uint8x16_t c1 = detail::swizzleU2301(v.r1);
+        const uint8x16_t c2 = detail::swizzleU2301(v.r2);
+        const uint8x16_t c3 = detail::swizzleU2301(v.r3);
+
+        // step 2 (the same byte shuffles as transposeAs4x4x4 uses)
+        const uint8x16_t s0a = detail::unpacklo8(c0, c1);
+        const uint8x16_t s0b = detail::unpackhi8(c0, c1);
+        const uint8x16_t s0c = detail::unpacklo8(c2, c3);
+        const uint8x16_t s0d = detail::unpackhi8(c2, c3);
+        const uint8x16_t s1a = detail::unpacklo8(s0a, s0b);
+        const uint8x16_t s1b = detail::unpackhi8(s0a, s0b);
+        const uint8x16_t s1c = detail::unpacklo8(s0c, s0d);
+        const uint8x16_t s1d = detail::unpackhi8(s0c, s0d);
+        const uint8x16_t s2a = detail::unpacklo8(s1a, s1b);
+        const uint8x16_t s2b = detail::unpackhi8(s1a, s1b);
+        const uint8x16_t s2c = detail::unpacklo8(s1c, s1d);
+        const uint8x16_t s2d = detail::unpackhi8(s1c, s1d);
+
+        const uint8x16_t s3a = detail::unpacklo32(s2a, s2b);
+        const uint8x16_t s3b = detail::unpackhi32(s2a, s2b);
+        const uint8x16_t s3c = detail::unpacklo32(s2c, s2d);
+        const uint8x16_t s3d = detail::unpackhi32(s2c, s2d);
+
+        // | 0.a | 0.b | 0.c | 0.d | 0.i | 0.j | 0.k | 0.l | 0.e | 0.f | 0.g | 0.h | 0.m | 0.n | 0.o | 0.p |
+        const uint8x16_t s4a = detail::unpacklo64(s3a, s3b);
+        const uint8x16_t s4b = detail::unpackhi64(s3a, s3b);
+        const uint8x16_t s4c = detail::unpacklo64(s3c, s3d);
+        const uint8x16_t s4d = detail::unpackhi64(s3c, s3d);
+
+        // step 3 (final)
+        uint8x16x4_t res;
+        // | 0.a | 0.b | 0.c | 0.d | 0.e | 0.f | 0.g | 0.h | 0.i | 0.j | 0.k | 0.l | 0.m | 0.n | 0.o | 0.p |
+        res.r0 = detail::swizzleU0213(s4a);
+        res.r1 = detail::swizzleU0213(s4b);
+        res.r2 = detail::swizzleU0213(s4c);
+        res.r3 = detail::swizzleU0213(s4d);
+        return res;
+    }
+
     // like ZipU4 but for two parallel zips
     //
     // in:
@@ -1026,50 +1531,462 @@ namespace simd
         return res;
     }
 
-#endif
-}
-
-static_assert(sizeof(uint8x16_t) == 16, "Incorrect byte8x16 sizeof");
-static_assert(sizeof(uint8x16x2_t) == 32, "Incorrect byte8x16x1 sizeof");
-static_assert(sizeof(uint8x16x3_t) == 48, "Incorrect byte8x16x2 sizeof");
-static_assert(sizeof(uint8x16x4_t) == 64, "Incorrect byte8x16x4 sizeof");
-static_assert(sizeof(uint64x2_t) == 16, "Incorrect uint64x2_t sizeof");
+    goofy_inline uint8x16_t popcount32(const uint8x16_t& a)
+    {
+        const uint32_t* lanes[4] = {&a.u0, &a.u1, &a.u2, &a.u3};
+        uint8x16_t res;
+        uint32_t* resLanes[4] = {&res.u0, &res.u1, &res.u2, &res.u3};
+        for (int i = 0; i < 4; i++)
+        {
+            uint32_t v = *lanes[i];
+            uint32_t count = 0;
+            while (v)
+            {
+                v &= v - 1;
+                count++;
+            }
+            *resLanes[i] = count;
+        }
+        return res;
+    }
 
+    goofy_inline uint8x16_t scaleU8(const uint8x16_t& a, const uint8x16_t& scale)
+    {
+        uint8x16_t res;
+        for (int i = 0; i < 16; i++)
+        {
+            const uint32_t v = (uint32_t(a.data[i]) * uint32_t(scale.data[(i & 7) * 2] | (scale.data[(i & 7) * 2 + 1] << 8))) >> 8;
+            res.data[i] = (uint8_t)(v > 255 ? 255 : v);
+        }
+        return res;
+    }
 
-// Block brightness variance to ETC control byte
-static const uint32_t etc1BrighnessRangeTocontrolByte[256] = {
-    0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000,
-    0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000,
-    0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000,
-    0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000,
-    0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000,
-    0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000,
-    0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
-    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
-    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
-    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000,
-    0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000,
-    0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
-    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
-    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
-    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
-    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xFF000000, 0xFF000000
-};
+    template<int S, uint32_t MASK>
+    goofy_inline uint8x16_t deltaSwap(const uint8x16_t& a)
+    {
+        const uint32_t t0 = ((a.u0 >> S) ^ a.u0) & MASK;
+        const uint32_t t1 = ((a.u1 >> S) ^ a.u1) & MASK;
+        const uint32_t t2 = ((a.u2 >> S) ^ a.u2) & MASK;
+        const uint32_t t3 = ((a.u3 >> S) ^ a.u3) & MASK;
+        uint8x16_t res;
+        res.u0 = a.u0 ^ t0 ^ (t0 << S);
+        res.u1 = a.u1 ^ t1 ^ (t1 << S);
+        res.u2 = a.u2 ^ t2 ^ (t2 << S);
+        res.u3 = a.u3 ^ t3 ^ (t3 << S);
+        return res;
+    }
 
+    goofy_inline void storeSumOfSquaresX4(uint32_t* res, const uint8x16_t& a, const uint8x16_t& b, const uint8x16_t& c, const uint8x16_t& d)
+    {
+        const uint8x16_t* v[4] = {&a, &b, &c, &d};
+        for (int j = 0; j < 4; j++)
+        {
+            uint32_t sum = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                sum += uint32_t(v[j]->data[i]) * uint32_t(v[j]->data[i]);
+            }
+            res[j] = sum;
+        }
+    }
 
-enum GoofyCodecType
-{
-    GOOFY_DXT1,
-    GOOFY_ETC1,
-};
+    goofy_inline uint32_t hashLinear(const uint8x16x4_t& bl)
+    {
+        const uint8x16_t* rows[4] = {&bl.r0, &bl.r1, &bl.r2, &bl.r3};
+        const int16_t* k = (const int16_t*)&gConstHashLinear;
+        uint32_t sum = 0;
+        for (int j = 0; j < 4; j++)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                const int16_t v = (int16_t)(rows[j]->data[i * 2] | (rows[j]->data[i * 2 + 1] << 8));
+                sum += (uint32_t)(int32_t(v) * int32_t(k[j * 8 + i]));
+            }
+        }
+        return sum;
+    }
 
-//
+    goofy_inline uint8x16_t hashMix(const uint8x16_t& acc, const uint8x16_t& v)
+    {
+        uint8x16_t res;
+        res.l0 = (acc.l0 ^ v.l0) * uint64_t(gConstHashMul[0]);
+        res.l1 = (acc.l1 ^ v.l1) * uint64_t(gConstHashMul[2]);
+        res.l0 ^= res.l0 >> 29;
+        res.l1 ^= res.l1 >> 29;
+        return res;
+    }
+
+    goofy_inline uint8x16_t bit_xor(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint8x16_t res;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            res.data[i] = a.data[i] ^ b.data[i];
+        }
+        return res;
+    }
+
+    // 16-bit lanes (wrap around)
+    goofy_inline uint8x16_t add16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)(va[i] + vb[i]);
+        }
+        return fetch(va);
+    }
+
+    goofy_inline uint8x16_t sub16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)(va[i] - vb[i]);
+        }
+        return fetch(va);
+    }
+
+    goofy_inline uint8x16_t mullo16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)(uint32_t(va[i]) * uint32_t(vb[i]));
+        }
+        return fetch(va);
+    }
+
+    // 16-bit lanes, (a * b) >> 16 (unsigned)
+    goofy_inline uint8x16_t mulhiu16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)((uint32_t(va[i]) * uint32_t(vb[i])) >> 16);
+        }
+        return fetch(va);
+    }
+
+    // 16-bit lanes (signed) to 32-bit lanes: a0 * b0 + a1 * b1
+    goofy_inline uint8x16_t madd16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        int16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        uint32_t res[4];
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            res[i] = (uint32_t)(int32_t(va[i * 2]) * int32_t(vb[i * 2]) + int32_t(va[i * 2 + 1]) * int32_t(vb[i * 2 + 1]));
+        }
+        return fetch(res);
+    }
+
+    // 32-bit lanes (wrap around)
+    goofy_inline uint8x16_t add32(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint8x16_t res;
+        res.u0 = a.u0 + b.u0;
+        res.u1 = a.u1 + b.u1;
+        res.u2 = a.u2 + b.u2;
+        res.u3 = a.u3 + b.u3;
+        return res;
+    }
+
+    // 16-bit lanes (signed)
+    goofy_inline uint8x16_t min16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        int16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (va[i] < vb[i]) ? va[i] : vb[i];
+        }
+        return fetch(va);
+    }
+
+    goofy_inline uint8x16_t max16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        int16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (va[i] > vb[i]) ? va[i] : vb[i];
+        }
+        return fetch(va);
+    }
+
+    goofy_inline uint8x16_t cmplt16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        int16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (va[i] < vb[i]) ? -1 : 0;
+        }
+        return fetch(va);
+    }
+
+    // 16-bit lanes (unsigned)
+    goofy_inline uint8x16_t avg16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint16_t va[8], vb[8];
+        memcpy(va, &a, sizeof(va));
+        memcpy(vb, &b, sizeof(vb));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)((uint32_t(va[i]) + uint32_t(vb[i]) + 1) >> 1);
+        }
+        return fetch(va);
+    }
+
+    template<int N>
+    goofy_inline uint8x16_t shiftLeft16(const uint8x16_t& a)
+    {
+        uint16_t va[8];
+        memcpy(va, &a, sizeof(va));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)(va[i] << N);
+        }
+        return fetch(va);
+    }
+
+    template<int N>
+    goofy_inline uint8x16_t shiftRight16(const uint8x16_t& a)
+    {
+        uint16_t va[8];
+        memcpy(va, &a, sizeof(va));
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            va[i] = (uint16_t)(va[i] >> N);
+        }
+        return fetch(va);
+    }
+
+    // 16-bit lanes to bytes (signed saturate), a = lower 8 bytes, b = upper 8 bytes
+    goofy_inline uint8x16_t packs16(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        int16_t v[16];
+        memcpy(v, &a, sizeof(a));
+        memcpy(v + 8, &b, sizeof(b));
+        uint8x16_t res;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            res.m128i_i8[i] = (int8_t)(v[i] < -128 ? -128 : (v[i] > 127 ? 127 : v[i]));
+        }
+        return res;
+    }
+
+    // swap 16-bit lanes inside every 32-bit lane
+    goofy_inline uint8x16_t swapPairs16(const uint8x16_t& a)
+    {
+        uint8x16_t res;
+        res.s0 = a.s1;
+        res.s1 = a.s0;
+        res.s2 = a.s3;
+        res.s3 = a.s2;
+        res.s4 = a.s5;
+        res.s5 = a.s4;
+        res.s6 = a.s7;
+        res.s7 = a.s6;
+        return res;
+    }
+
+    //
+    // in:
+    //
+    // a  = | a0 | a1 | a2 | a3 | a4 | a5 | a6 | a7 |
+    // b  = | b0 | b1 | b2 | b3 | b4 | b5 | b6 | b7 |
+    //
+    // out:
+    //
+    // R0  = | a0 | b0 | a1 | b1 | a2 | b2 | a3 | b3 |
+    // R1  = | a4 | b4 | a5 | b5 | a6 | b6 | a7 | b7 |
+    //
+    goofy_inline uint8x16x2_t zipU2(const uint8x16_t& a, const uint8x16_t& b)
+    {
+        uint8x16x2_t res;
+        res.r0 = detail::unpacklo16(a, b);
+        res.r1 = detail::unpackhi16(a, b);
+        return res;
+    }
+
+#endif
+}
+
+static_assert(sizeof(uint8x16_t) == 16, "Incorrect byte8x16 sizeof");
+static_assert(sizeof(uint8x16x2_t) == 32, "Incorrect byte8x16x1 sizeof");
+static_assert(sizeof(uint8x16x3_t) == 48, "Incorrect byte8x16x2 sizeof");
+static_assert(sizeof(uint8x16x4_t) == 64, "Incorrect byte8x16x4 sizeof");
+static_assert(sizeof(uint64x2_t) == 16, "Incorrect uint64x2_t sizeof");
+
+
+// Block brightness variance to ETC control byte
+static const uint32_t etc1BrighnessRangeTocontrolByte[256] = {
+    0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000,
+    0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x03000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000,
+    0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x27000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000,
+    0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000,
+    0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x4B000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000,
+    0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000,
+    0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x6F000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
+    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
+    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000,
+    0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0x93000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000,
+    0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000,
+    0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xB7000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
+    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
+    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
+    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000,
+    0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xDB000000, 0xFF000000, 0xFF000000
+};
+
+
+// ETC1 large intensity modifier (per table codeword) replicated to RGB
+//
+//              [0]    [1]    [2]     [3]
+// 0x03 [0]     -8     -2      2       8
+// 0x27 [1]    -17     -5      5      17
+// 0x4B [2]    -29     -9      9      29
+// 0x6F [3]    -42    -13     13      42
+// 0x93 [4]    -60    -18     18      60
+// 0xB7 [5]    -80    -24     24      80
+// 0xDB [6]   -106    -33     33     106
+// 0xFF [7]   -183    -47     47     183
+static const uint32_t etc1LargeModifierRGB[8] = {
+    0x00080808, 0x00111111, 0x001D1D1D, 0x002A2A2A, 0x003C3C3C, 0x00505050, 0x006A6A6A, 0x00B7B7B7
+};
+
+
+enum GoofyCodecType
+{
+    GOOFY_DXT1,
+    GOOFY_ETC1,
+};
+
+// Convert rgb888 to rgb555
+//
+// We can't shift right by 3 using SIMD, but we can shift right by 1 three times instead
+// We need to sub eight before, because avg is (a+b+1) >> 1
+goofy_inline uint8x16_t convertRgb888ToRgb555(const uint8x16_t& colors)
+{
+    const uint8x16_t constEight = simd::fetch(&gConstEight);
+    const uint8x16_t constZero = simd::zero();
+    return simd::avg(simd::avg(simd::avg(simd::subsatu(colors, constEight), constZero), constZero), constZero);
+}
+
+// Pack two rgb555 colors (max555.rgba | min555.rgba) to the first half of DXT1 block
+//
+// R0
+// AAAAAAAA000000000000000000000000AAAAAAAA000000000000000000011111b << 11 = 0000000000000000 1111100000000000b
+// AAAAAAAA000000000000000000000000AAAAAAAA000000000001111100000000b >> 2  = 0000000000000000 0000011111000000b
+// AAAAAAAA000000000000000000000000AAAAAAAA000111110000000000000000b >> 16 = 0000000000000000 0000000000011111b
+//
+// R1
+// AAAAAAAA000000000000000000011111AAAAAAAA000000000000000000000000b >> 5 =  1111100000000000 0000000000000000b
+// AAAAAAAA000000000001111100000000AAAAAAAA000000000000000000000000b >> 18 = 0000011111000000 0000000000000000b
+// AAAAAAAA000111110000000000000000AAAAAAAA000000000000000000000000b >> 32 = 0000000000011111 0000000000000000b
+//
+// 0x20                                                                    = 0000000000000000 0000000000100000b
+goofy_inline uint32_t packDXT1Colors555(uint64_t maxMin)
+{
+    return (uint32_t)(0x20 | // max color green channel LSB (to avoid switching to DXT1 3-color mode)
+        (maxMin & 0x1Full) << 11ull | (maxMin & 0x1F00ull) >> 2ull | (maxMin & 0x1F0000ull) >> 16ull |  // max color
+        (maxMin & 0x1F00000000ull) >> 5ull | (maxMin & 0x1F0000000000ull) >> 18ull | (maxMin & 0x1F000000000000ull) >> 32ull); // min color
+}
+
+// Hash of 4x4 pixels (two 64-bit lanes)
+goofy_inline uint8x16_t hashBlock(const uint8x16x4_t& bl)
+{
+    return simd::hashMix(simd::hashMix(simd::hashMix(simd::hashMix(simd::zero(), bl.r0), bl.r1), bl.r2), bl.r3);
+}
+
+// Fold hash lanes to 64-bit value, never returns zero
+goofy_inline uint64_t hashFinalize(const uint8x16_t& h)
+{
+    const uint64x2_t lanes = simd::getAsUInt64x2(h);
+    uint64_t res = lanes.r0 * uint64_t(gConstHashMul[0]);
+    res ^= (res >> 29) ^ lanes.r1;
+    return res | 1;
+}
+
+// Hash of 16x4 pixels (temporal mode), never returns zero
+//
+// Four independent chains (one per block) to hide the multiplication latency, combined in order
+goofy_inline uint64_t hashStrip(const uint8x16x4_t& bl0, const uint8x16x4_t& bl1, const uint8x16x4_t& bl2, const uint8x16x4_t& bl3)
+{
+    const uint8x16_t h = simd::hashMix(simd::hashMix(simd::hashMix(simd::hashMix(simd::zero(), hashBlock(bl0)), hashBlock(bl1)), hashBlock(bl2)), hashBlock(bl3));
+    return hashFinalize(h);
+}
+
+// Store four 32-bit lanes
+goofy_inline void storeLanes(const uint8x16_t& v, uint32_t* goofy_restrict dst)
+{
+    const uint64x2_t lanes = simd::getAsUInt64x2(v);
+    dst[0] = (uint32_t)lanes.r0;
+    dst[1] = (uint32_t)(lanes.r0 >> 32ull);
+    dst[2] = (uint32_t)lanes.r1;
+    dst[3] = (uint32_t)(lanes.r1 >> 32ull);
+}
+
+#ifdef GOOFY_PROFILE
+static thread_local ProfileCounters gProfileCounters = {};
+
+goofy_inline uint64_t readProfileTicks()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+ProfileCounters getProfileCounters()
+{
+    return gProfileCounters;
+}
+
+void resetProfileCounters()
+{
+    gProfileCounters = ProfileCounters();
+}
+
+// accumulate ticks since the previous stage (or begin) to the given counter
+#define GOOFY_PROFILE_BEGIN() uint64_t goofyProfileTicks = readProfileTicks()
+#define GOOFY_PROFILE_STAGE(counter) \
+    { \
+        const uint64_t goofyProfileNow = readProfileTicks(); \
+        gProfileCounters.counter += goofyProfileNow - goofyProfileTicks; \
+        goofyProfileTicks = goofyProfileNow; \
+    }
+#define GOOFY_PROFILE_COUNT(counter) gProfileCounters.counter++
+#else
+#define GOOFY_PROFILE_BEGIN()
+#define GOOFY_PROFILE_STAGE(counter)
+#define GOOFY_PROFILE_COUNT(counter)
+#endif
+
+//
 // Encode 4 DXT1/ETC1 at once
 //
 template<GoofyCodecType CODEC_TYPE>
-goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA, size_t inputStride, unsigned char* goofy_restrict pResult)
+goofy_inline bool goofySimdEncode(const unsigned char* goofy_restrict inputRGBA, size_t inputStride, unsigned char* goofy_restrict pResult, uint32_t* goofy_restrict pBlockErrors = nullptr,
+                                  uint64_t* goofy_restrict pStripHash = nullptr, EncoderStats* goofy_restrict pStats = nullptr)
 {
-    assert(uintptr_t(inputRGBA) % 64 == 0); // make sure the input is 64 bit aligned.
+    assert(uintptr_t(inputRGBA) % 16 == 0); // make sure the input is 16 bytes aligned (64 bytes is better for the CPU cache)
+    GOOFY_PROFILE_BEGIN();
 
     // Fetch 16x4 pixels from the buffer(four DX blocks)
     // 16 pixels wide is better for the CPU cache utilization (64 bytes per line) and it is better for SIMD lane utilization
@@ -1098,6 +2015,21 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
     bl2.r3 = simd::fetch(inputRGBA + 32);
     bl3.r3 = simd::fetch(inputRGBA + 48);
 
+    // Skip unchanged strip (optional)
+    // -----------------------------------------------------------
+    if (pStripHash)
+    {
+        const uint64_t stripHash = hashStrip(bl0, bl1, bl2, bl3);
+        if (stripHash == *pStripHash)
+        {
+            GOOFY_PROFILE_STAGE(fetchTicks);
+            return false;
+        }
+        *pStripHash = stripHash;
+    }
+    GOOFY_PROFILE_STAGE(fetchTicks);
+    GOOFY_PROFILE_COUNT(numStrips);
+
     // Find min block colors
     // -----------------------------------------------------------
     const uint8x16x4_t blMin = {
@@ -1138,6 +2070,7 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
         simd::maxu(blMaxTr.r0, blMaxTr.r1),
         simd::maxu(blMaxTr.r2, blMaxTr.r3)
     );
+    GOOFY_PROFILE_STAGE(minMaxTicks);
 
     // Find min/max brigtness
     // -----------------------------------------------------------
@@ -1173,7 +2106,8 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
     // Clamp to min brightness
     const uint8x16_t constEight = simd::fetch(&gConstEight);
     // range0.yyyy | range1.yyyy | range2.yyyy | range3.yyyy
-    const uint8x16_t blRangeY = simd::maxu(simd::subsatu(blMinMaxY.r1, blMinMaxY.r0), constEight);
+    const uint8x16_t blRawRangeY = simd::subsatu(blMinMaxY.r1, blMinMaxY.r0);
+    const uint8x16_t blRangeY = simd::maxu(blRawRangeY, constEight);
 
     // mid0.yyyy | mid1.yyyy | mid2.yyyy | mid3.yyyy
     const uint8x16_t blMidY = simd::avg(blMinMaxY.r0, blMinMaxY.r1);
@@ -1270,6 +2204,74 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
     const uint8x16_t bl3AbsDiffY = simd::bit_or(bl3PosDiffY, bl3NegDiffY);
     const uint8x16_t bl3QThreshold = simd::replicateU3333(blQThreshold);
     const uint8x16_t bl3LqtMask = simd::cmplti(bl3AbsDiffY, bl3QThreshold);
+    GOOFY_PROFILE_STAGE(quantizeTicks);
+
+    // Estimate per-block error (optional)
+    // -----------------------------------------------------------
+    if (pBlockErrors)
+    {
+        // Sum of squared brightness errors, the reconstructed brightness is approximated as
+        //
+        //  mid +/- outer level (if |diff| >= qt), outer = range * 0.5 (DXT1 end points or ETC1 large modifier)
+        //  mid +/- inner level (if |diff| < qt), inner = range * 0.15625 (DXT1 1/3 + 2/3 colors or ETC1 small modifier)
+        //
+        // NOTE: range is clamped to min brightness, so flat blocks get small non zero error (end points quantization)
+        const uint8x16_t blInnerLevelY = simd::avg(blEighthsRangeY, simd::avg(blEighthsRangeY, blQuarterRangeY));
+
+        const uint8x16_t bl0LevelY = simd::select(bl0LqtMask, simd::replicateU0000(blInnerLevelY), simd::replicateU0000(blHalfRangeY));
+        const uint8x16_t bl1LevelY = simd::select(bl1LqtMask, simd::replicateU1111(blInnerLevelY), simd::replicateU1111(blHalfRangeY));
+        const uint8x16_t bl2LevelY = simd::select(bl2LqtMask, simd::replicateU2222(blInnerLevelY), simd::replicateU2222(blHalfRangeY));
+        const uint8x16_t bl3LevelY = simd::select(bl3LqtMask, simd::replicateU3333(blInnerLevelY), simd::replicateU3333(blHalfRangeY));
+
+        const uint8x16_t bl0ErrorY = simd::bit_or(simd::subsatu(bl0AbsDiffY, bl0LevelY), simd::subsatu(bl0LevelY, bl0AbsDiffY));
+        const uint8x16_t bl1ErrorY = simd::bit_or(simd::subsatu(bl1AbsDiffY, bl1LevelY), simd::subsatu(bl1LevelY, bl1AbsDiffY));
+        const uint8x16_t bl2ErrorY = simd::bit_or(simd::subsatu(bl2AbsDiffY, bl2LevelY), simd::subsatu(bl2LevelY, bl2AbsDiffY));
+        const uint8x16_t bl3ErrorY = simd::bit_or(simd::subsatu(bl3AbsDiffY, bl3LevelY), simd::subsatu(bl3LevelY, bl3AbsDiffY));
+
+        simd::storeSumOfSquaresX4(pBlockErrors, bl0ErrorY, bl1ErrorY, bl2ErrorY, bl3ErrorY);
+        GOOFY_PROFILE_STAGE(errorTicks);
+    }
+
+    // Collect encoder statistics (optional)
+    // -----------------------------------------------------------
+    if (pStats)
+    {
+        // Brightness difference is clamped if MSB of the unclamped difference is set (diff > 127)
+        // Pack clamp bits of 4 blocks into one vector (bits 7..4 of every byte) and count them
+        const uint8x16_t constSignBits = simd::fetch(&gConstSignBits);
+        const uint8x16_t bl0ClampedY = simd::bit_and(simd::bit_or(simd::subsatu(bl0Y, bl0MidY), simd::subsatu(bl0MidY, bl0Y)), constSignBits);
+        const uint8x16_t bl1ClampedY = simd::bit_and(simd::bit_or(simd::subsatu(bl1Y, bl1MidY), simd::subsatu(bl1MidY, bl1Y)), constSignBits);
+        const uint8x16_t bl2ClampedY = simd::bit_and(simd::bit_or(simd::subsatu(bl2Y, bl2MidY), simd::subsatu(bl2MidY, bl2Y)), constSignBits);
+        const uint8x16_t bl3ClampedY = simd::bit_and(simd::bit_or(simd::subsatu(bl3Y, bl3MidY), simd::subsatu(bl3MidY, bl3Y)), constSignBits);
+        const uint8x16_t blClampedY = simd::bit_or(simd::bit_or(bl0ClampedY, simd::shiftRight<1>(bl1ClampedY)),
+                                                   simd::bit_or(simd::shiftRight<2>(bl2ClampedY), simd::shiftRight<3>(bl3ClampedY)));
+
+        // range0.yyyy | range1.yyyy | range2.yyyy | range3.yyyy - 0xFF if range is less than min brightness
+        const uint8x16_t blRangeClamped = simd::bitnot(simd::cmpeqi(simd::subsatu(constEight, blRawRangeY), constZero));
+
+        // Solid color blocks (all 32 bits of the lane are set, partially equal colors set less bits)
+        const uint8x16_t constAlphaMask = simd::fetch(&gConstAlphaMask);
+        const uint8x16_t blFlat = simd::cmpeqi(simd::bit_or(minColors, constAlphaMask), simd::bit_or(maxColors, constAlphaMask));
+
+        goofy_align16(uint32_t numClamped[4]);
+        goofy_align16(uint32_t numRangeClamped[4]);
+        goofy_align16(uint32_t numFlat[4]);
+        storeLanes(simd::popcount32(blClampedY), numClamped);
+        storeLanes(simd::popcount32(blRangeClamped), numRangeClamped);
+        storeLanes(simd::popcount32(blFlat), numFlat);
+
+        pStats->numBlocks += 4;
+        pStats->numClampedPixels += numClamped[0] + numClamped[1] + numClamped[2] + numClamped[3];
+        pStats->numRangeClampedBlocks += (numRangeClamped[0] + numRangeClamped[1] + numRangeClamped[2] + numRangeClamped[3]) >> 5;
+        pStats->numFlatBlocks += (numFlat[0] >> 5) + (numFlat[1] >> 5) + (numFlat[2] >> 5) + (numFlat[3] >> 5);
+        if (CODEC_TYPE == GOOFY_ETC1)
+        {
+            pStats->numEtcTableBlocks[etc1BrighnessRangeTocontrolByte[vector_get_by_index<0>(blRangeY)] >> 29]++;
+            pStats->numEtcTableBlocks[etc1BrighnessRangeTocontrolByte[vector_get_by_index<4>(blRangeY)] >> 29]++;
+            pStats->numEtcTableBlocks[etc1BrighnessRangeTocontrolByte[vector_get_by_index<8>(blRangeY)] >> 29]++;
+            pStats->numEtcTableBlocks[etc1BrighnessRangeTocontrolByte[vector_get_by_index<12>(blRangeY)] >> 29]++;
+        }
+    }
 
     // Finalize blocks
     // -----------------------------------------------------------
@@ -1302,13 +2304,10 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
 
         // Convert rgb888 to rgb555
 
-        // We can't shift right by 3 using SIMD, but we can shift right by 1 three times instead
-        // We need to sub eight before, because avg is (a+b+1) >> 1
-
         // max555_0.rgba | max555_1.rgba | max555_2.rgba | max555_3.rgba
-        const uint8x16_t maxColors555 = simd::avg(simd::avg(simd::avg(simd::subsatu(maxColors, constEight), constZero), constZero), constZero);
+        const uint8x16_t maxColors555 = convertRgb888ToRgb555(maxColors);
         // min555_0.rgba | min555_1.rgba | min555_2.rgba | min555_3.rgba
-        const uint8x16_t minColors555 = simd::avg(simd::avg(simd::avg(simd::subsatu(minColors, constEight), constZero), constZero), constZero);
+        const uint8x16_t minColors555 = convertRgb888ToRgb555(minColors);
 
         // max555_0.rgba | min555_0.rgba | max555_1.rgba | min555_1.rgba
         // max555_2.rgba | min555_2.rgba | max555_3.rgba | min555_3.rgba
@@ -1317,41 +2316,21 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
         const uint64x2_t maxMin01 = simd::getAsUInt64x2(maxMinColors555.r0);
         const uint64x2_t maxMin23 = simd::getAsUInt64x2(maxMinColors555.r1);
 
-        // R0
-        // AAAAAAAA000000000000000000000000AAAAAAAA000000000000000000011111b << 11 = 0000000000000000 1111100000000000b
-        // AAAAAAAA000000000000000000000000AAAAAAAA000000000001111100000000b >> 2  = 0000000000000000 0000011111000000b
-        // AAAAAAAA000000000000000000000000AAAAAAAA000111110000000000000000b >> 16 = 0000000000000000 0000000000011111b
-        
-        // R1
-        // AAAAAAAA000000000000000000011111AAAAAAAA000000000000000000000000b >> 5 =  1111100000000000 0000000000000000b
-        // AAAAAAAA000000000001111100000000AAAAAAAA000000000000000000000000b >> 18 = 0000011111000000 0000000000000000b
-        // AAAAAAAA000111110000000000000000AAAAAAAA000000000000000000000000b >> 32 = 0000000000011111 0000000000000000b
-
-        // 0x20                                                                    = 0000000000000000 0000000000100000b
-
         uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
 
-        uint32_t block0a = (uint32_t)(0x20 | // max color green channel LSB (to avoid switching to DXT1 3-color mode)
-            (maxMin01.r0 & 0x1Full) << 11ull | (maxMin01.r0 & 0x1F00ull) >> 2ull | (maxMin01.r0 & 0x1F0000ull) >> 16ull |  // max color
-            (maxMin01.r0 & 0x1F00000000ull) >> 5ull | (maxMin01.r0 & 0x1F0000000000ull) >> 18ull | (maxMin01.r0 & 0x1F000000000000ull) >> 32ull); // min color
+        uint32_t block0a = packDXT1Colors555(maxMin01.r0);
         //uint32_t block0b = bl0Indices << 32ull;  // indices
         *pDest = block0a; pDest++; *pDest = bl0Indices;
 
-        uint32_t block1a = (uint32_t)(0x20 |
-            (maxMin01.r1 & 0x1Full) << 11ull | (maxMin01.r1 & 0x1F00ull) >> 2ull | (maxMin01.r1 & 0x1F0000ull) >> 16ull |
-            (maxMin01.r1 & 0x1F00000000ull) >> 5ull | (maxMin01.r1 & 0x1F0000000000ull) >> 18ull | (maxMin01.r1 & 0x1F000000000000ull) >> 32ull);
+        uint32_t block1a = packDXT1Colors555(maxMin01.r1);
         //uint32_t block1b = bl1Indices << 32ull;
         pDest++; *pDest = block1a; pDest++; *pDest = bl1Indices;
 
-        uint32_t block2a = (uint32_t)(0x20 |
-            (maxMin23.r0 & 0x1Full) << 11ull | (maxMin23.r0 & 0x1F00ull) >> 2ull | (maxMin23.r0 & 0x1F0000ull) >> 16ull |
-            (maxMin23.r0 & 0x1F00000000ull) >> 5ull | (maxMin23.r0 & 0x1F0000000000ull) >> 18ull | (maxMin23.r0 & 0x1F000000000000ull) >> 32ull);
+        uint32_t block2a = packDXT1Colors555(maxMin23.r0);
             //bl2Indices << 32ull;
         pDest++; *pDest = block2a; pDest++; *pDest = bl2Indices;
 
-        uint32_t block3a = (uint32_t)(0x20 |
-            (maxMin23.r1 & 0x1Full) << 11ull | (maxMin23.r1 & 0x1F00ull) >> 2ull | (maxMin23.r1 & 0x1F0000ull) >> 16ull |
-            (maxMin23.r1 & 0x1F00000000ull) >> 5ull | (maxMin23.r1 & 0x1F0000000000ull) >> 18ull | (maxMin23.r1 & 0x1F000000000000ull) >> 32ull);
+        uint32_t block3a = packDXT1Colors555(maxMin23.r1);
             //bl3Indices << 32ull;
         pDest++; *pDest = block3a; pDest++; *pDest = bl3Indices;
     }
@@ -1455,11 +2434,8 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
 
         // Convert rgb888 to rgb555
 
-        // We can't shift right by 3 using SIMD, but we can shift right by 1 three times instead
-        // We need to sub eight before, because avg is (a+b+1) >> 1
-
         // mid555_0.rgba | mid555_1.rgba | mid555_2.rgba | mid555_3.rgba
-        const uint8x16_t baseColors555 = simd::avg(simd::avg(simd::avg(simd::subsatu(blBaseColors, constEight), constZero), constZero), constZero);
+        const uint8x16_t baseColors555 = convertRgb888ToRgb555(blBaseColors);
 
         const uint64x2_t baseColors = simd::getAsUInt64x2(baseColors555);
 
@@ -1491,6 +2467,8 @@ goofy_inline void goofySimdEncode(const unsigned char* goofy_restrict inputRGBA,
         const uint32_t block3b = ~(bl3PosOrZero | (bl3LessThanQt << 16));
         pDest++; *pDest = block3a; pDest++; *pDest = block3b;
     }
+    GOOFY_PROFILE_STAGE(finalizeTicks);
+    return true;
 }
 
 
@@ -1510,6 +2488,7 @@ int compressDXT1(unsigned char* result, const unsigned char* input, unsigned int
     unsigned int blockW = width >> 2;
     unsigned int blockH = height >> 2;
 
+    GOOFY_PROFILE_BEGIN();
     size_t inputStride = stride;
     for (uint32_t y = 0; y < blockH; y++)
     {
@@ -1522,6 +2501,8 @@ int compressDXT1(unsigned char* result, const unsigned char* input, unsigned int
         }
         input += inputStride * 4; // 4 lines
     }
+    GOOFY_PROFILE_STAGE(imageTicks);
+    GOOFY_PROFILE_COUNT(numImages);
     return 0;
 }
 
@@ -1541,6 +2522,7 @@ int compressETC1(unsigned char* result, const unsigned char* input, unsigned int
     unsigned int blockW = width >> 2;
     unsigned int blockH = height >> 2;
 
+    GOOFY_PROFILE_BEGIN();
     size_t inputStride = stride;
     for (uint32_t y = 0; y < blockH; y++)
     {
@@ -1553,14 +2535,2181 @@ int compressETC1(unsigned char* result, const unsigned char* input, unsigned int
         }
         input += inputStride * 4; // 4 lines
     }
+    GOOFY_PROFILE_STAGE(imageTicks);
+    GOOFY_PROFILE_COUNT(numImages);
+    return 0;
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressWithErrorMap(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap)
+{
+    // those checks are required because of 4x1 block window inside the compressor
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    unsigned int blockW = width >> 2;
+    unsigned int blockH = height >> 2;
+
+    size_t inputStride = stride;
+    for (uint32_t y = 0; y < blockH; y++)
+    {
+        const unsigned char* goofy_restrict encoderPos = input;
+        for (uint32_t x = 0; x < blockW; x += 4)
+        {
+            goofySimdEncode<CODEC_TYPE>(encoderPos, inputStride, result, errorMap);
+            encoderPos += 64; // 16 rgba pixels (4 DXT blocks) = 16 * 4 = 64
+            result += 32;     // 4 DXT1 blocks = 8 * 4 = 32
+            errorMap += 4;    // 4 blocks
+        }
+        input += inputStride * 4; // 4 lines
+    }
     return 0;
 }
 
+int compressDXT1WithErrorMap(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap)
+{
+    return compressWithErrorMap<GOOFY_DXT1>(result, input, width, height, stride, errorMap);
+}
+
+int compressETC1WithErrorMap(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap)
+{
+    return compressWithErrorMap<GOOFY_ETC1>(result, input, width, height, stride, errorMap);
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressWithStats(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, EncoderStats* stats)
+{
+    // those checks are required because of 4x1 block window inside the compressor
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    unsigned int blockW = width >> 2;
+    unsigned int blockH = height >> 2;
+
+    size_t inputStride = stride;
+    for (uint32_t y = 0; y < blockH; y++)
+    {
+        const unsigned char* goofy_restrict encoderPos = input;
+        for (uint32_t x = 0; x < blockW; x += 4)
+        {
+            goofySimdEncode<CODEC_TYPE>(encoderPos, inputStride, result, nullptr, nullptr, stats);
+            encoderPos += 64; // 16 rgba pixels (4 DXT blocks) = 16 * 4 = 64
+            result += 32;     // 4 DXT1 blocks = 8 * 4 = 32
+        }
+        input += inputStride * 4; // 4 lines
+    }
+    return 0;
+}
+
+int compressDXT1WithStats(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, EncoderStats* stats)
+{
+    return compressWithStats<GOOFY_DXT1>(result, input, width, height, stride, stats);
+}
+
+int compressETC1WithStats(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, EncoderStats* stats)
+{
+    return compressWithStats<GOOFY_ETC1>(result, input, width, height, stride, stats);
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressTemporal(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips)
+{
+    // those checks are required because of 4x1 block window inside the compressor
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    unsigned int blockW = width >> 2;
+    unsigned int blockH = height >> 2;
+
+    const uint32_t numStrips = (blockW >> 2) * blockH;
+    for (uint32_t i = 0; i < (numStrips + 31) / 32; i++)
+    {
+        changedStrips[i] = 0;
+    }
+
+    int numChanged = 0;
+    uint32_t stripIndex = 0;
+    size_t inputStride = stride;
+    for (uint32_t y = 0; y < blockH; y++)
+    {
+        const unsigned char* goofy_restrict encoderPos = input;
+        for (uint32_t x = 0; x < blockW; x += 4)
+        {
+            if (goofySimdEncode<CODEC_TYPE>(encoderPos, inputStride, result, nullptr, stripHashes + stripIndex))
+            {
+                changedStrips[stripIndex >> 5] |= (1u << (stripIndex & 31));
+                numChanged++;
+            }
+            encoderPos += 64; // 16 rgba pixels (4 DXT blocks) = 16 * 4 = 64
+            result += 32;     // 4 DXT1 blocks = 8 * 4 = 32
+            stripIndex++;
+        }
+        input += inputStride * 4; // 4 lines
+    }
+    return numChanged;
+}
+
+int compressDXT1Temporal(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips)
+{
+    return compressTemporal<GOOFY_DXT1>(result, input, width, height, stride, stripHashes, changedStrips);
+}
+
+int compressETC1Temporal(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips)
+{
+    return compressTemporal<GOOFY_ETC1>(result, input, width, height, stride, stripHashes, changedStrips);
+}
+
+// Open addressing hash table (linear probing), exact pixels comparison on hit
+struct BlockCache
+{
+    static const uint32_t kNumEntriesLog2 = 11;
+    static const uint32_t kNumEntries = 1 << kNumEntriesLog2; // 2048 * 80 bytes = 160 KB, fits into L2
+    static const uint32_t kMaxProbes = 4;
+
+    struct Entry
+    {
+        uint8x16x4_t pixels;
+        uint32_t hash; // zero = empty
+        uint32_t padding;
+        uint32_t result[2];
+    };
+
+    Entry entries[kNumEntries];
+    GoofyCodecType codec;
+    uint64_t numLookups;
+    uint64_t numHits;
+};
+
+BlockCache* createBlockCache()
+{
+    BlockCache* cache = new BlockCache();
+    cache->codec = GOOFY_DXT1;
+    cache->numLookups = 0;
+    cache->numHits = 0;
+    return cache;
+}
+
+void destroyBlockCache(BlockCache* cache)
+{
+    delete cache;
+}
+
+void getBlockCacheStats(const BlockCache* cache, uint64_t* numLookups, uint64_t* numHits)
+{
+    *numLookups = cache->numLookups;
+    *numHits = cache->numHits;
+}
+
+goofy_inline bool isEqual(const uint8x16x4_t& a, const uint8x16x4_t& b)
+{
+    const uint8x16_t eq = simd::bit_and(simd::bit_and(simd::cmpeqi(a.r0, b.r0), simd::cmpeqi(a.r1, b.r1)),
+                                        simd::bit_and(simd::cmpeqi(a.r2, b.r2), simd::cmpeqi(a.r3, b.r3)));
+    return simd::moveMaskMSB(eq) == 0xFFFF;
+}
+
+// Block hash (never zero) and the table index (fibonacci hashing)
+goofy_inline uint32_t getBlockCacheHash(const uint8x16x4_t& bl)
+{
+    return simd::hashLinear(bl) | 1;
+}
+
+goofy_inline uint32_t getBlockCacheIndex(uint32_t hash)
+{
+    return (hash * 0x9E3779B1u) >> (32 - BlockCache::kNumEntriesLog2);
+}
+
+goofy_inline const BlockCache::Entry* findBlock(const BlockCache* goofy_restrict cache, uint32_t hash, const uint8x16x4_t& bl)
+{
+    const uint32_t index = getBlockCacheIndex(hash);
+    for (uint32_t probe = 0; probe < BlockCache::kMaxProbes; probe++)
+    {
+        const BlockCache::Entry& entry = cache->entries[(index + probe) & (BlockCache::kNumEntries - 1)];
+        if (entry.hash == 0)
+        {
+            return nullptr;
+        }
+        if (entry.hash == hash && isEqual(entry.pixels, bl))
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+goofy_inline void insertBlock(BlockCache* goofy_restrict cache, uint32_t hash, const uint8x16x4_t& bl, const uint32_t* result)
+{
+    // take the first empty slot or replace the first one
+    const uint32_t index = getBlockCacheIndex(hash);
+    BlockCache::Entry* entry = &cache->entries[index & (BlockCache::kNumEntries - 1)];
+    for (uint32_t probe = 0; probe < BlockCache::kMaxProbes; probe++)
+    {
+        BlockCache::Entry* candidate = &cache->entries[(index + probe) & (BlockCache::kNumEntries - 1)];
+        if (candidate->hash == 0)
+        {
+            entry = candidate;
+            break;
+        }
+    }
+    entry->pixels = bl;
+    entry->hash = hash;
+    entry->result[0] = result[0];
+    entry->result[1] = result[1];
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressDedup(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, BlockCache* goofy_restrict cache)
+{
+    // those checks are required because of 4x1 block window inside the compressor
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    if (cache->codec != CODEC_TYPE)
+    {
+        for (uint32_t i = 0; i < BlockCache::kNumEntries; i++)
+        {
+            cache->entries[i].hash = 0;
+        }
+        cache->codec = CODEC_TYPE;
+    }
+
+    unsigned int blockW = width >> 2;
+    unsigned int blockH = height >> 2;
+
+    size_t inputStride = stride;
+    uint64_t numHits = 0;
+    for (uint32_t y = 0; y < blockH; y++)
+    {
+        const unsigned char* goofy_restrict encoderPos = input;
+        for (uint32_t x = 0; x < blockW; x += 4)
+        {
+            uint8x16x4_t bl[4];
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                bl[i].r0 = simd::fetch(encoderPos + i * 16);
+                bl[i].r1 = simd::fetch(encoderPos + inputStride + i * 16);
+                bl[i].r2 = simd::fetch(encoderPos + inputStride * 2 + i * 16);
+                bl[i].r3 = simd::fetch(encoderPos + inputStride * 3 + i * 16);
+            }
+
+            uint32_t hashes[4];
+            const BlockCache::Entry* entries[4];
+            uint32_t numFound = 0;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                hashes[i] = getBlockCacheHash(bl[i]);
+                entries[i] = findBlock(cache, hashes[i], bl[i]);
+                numFound += (entries[i] != nullptr) ? 1 : 0;
+            }
+
+            uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)result;
+            if (numFound == 4)
+            {
+                // the whole strip is cached
+                numHits += 4;
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    pDest[i * 2 + 0] = entries[i]->result[0];
+                    pDest[i * 2 + 1] = entries[i]->result[1];
+                }
+            }
+            else
+            {
+                goofySimdEncode<CODEC_TYPE>(encoderPos, inputStride, result);
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    if (entries[i] == nullptr)
+                    {
+                        insertBlock(cache, hashes[i], bl[i], pDest + i * 2);
+                    }
+                }
+            }
+
+            encoderPos += 64; // 16 rgba pixels (4 DXT blocks) = 16 * 4 = 64
+            result += 32;     // 4 DXT1 blocks = 8 * 4 = 32
+        }
+        input += inputStride * 4; // 4 lines
+    }
+
+    cache->numLookups += uint64_t(blockW) * uint64_t(blockH);
+    cache->numHits += numHits;
+    return 0;
+}
+
+int compressDXT1Dedup(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, BlockCache* cache)
+{
+    return compressDedup<GOOFY_DXT1>(result, input, width, height, stride, cache);
+}
+
+int compressETC1Dedup(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, BlockCache* cache)
+{
+    return compressDedup<GOOFY_ETC1>(result, input, width, height, stride, cache);
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressRegion(unsigned char* dst, unsigned int dstPitch, const unsigned char* src, unsigned int srcStride, unsigned int width, unsigned int height, unsigned int x,
+                   unsigned int y, unsigned int w, unsigned int h)
+{
+    if (width % 4 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    // written this way to avoid overflow of x + w / y + h
+    if (x > width || w > width - x || y > height || h > height - y)
+    {
+        return -3;
+    }
+
+    if (w == 0 || h == 0)
+    {
+        return 0;
+    }
+
+    // Snap to block boundaries
+    const unsigned int blockX0 = x >> 2;
+    const unsigned int blockY0 = y >> 2;
+    const unsigned int blockX1 = (x + w + 3) >> 2;
+    const unsigned int blockY1 = (y + h + 3) >> 2;
+
+    // 16x4 strips (4 blocks) + up to 3 remaining blocks
+    const unsigned int numStrips = (blockX1 - blockX0) >> 2;
+    const unsigned int numTailBlocks = (blockX1 - blockX0) & 3;
+
+    goofy_align16(unsigned char tailStrip[256]);
+    unsigned char tailResult[32];
+
+    size_t inputStride = srcStride;
+    for (uint32_t by = blockY0; by < blockY1; by++)
+    {
+        const unsigned char* goofy_restrict encoderPos = src + size_t(by) * 4 * inputStride + size_t(blockX0) * 16;
+        unsigned char* goofy_restrict result = dst + size_t(by) * dstPitch + size_t(blockX0) * 8;
+        for (uint32_t i = 0; i < numStrips; i++)
+        {
+            goofySimdEncode<CODEC_TYPE>(encoderPos, inputStride, result);
+            encoderPos += 64; // 16 rgba pixels (4 DXT blocks) = 16 * 4 = 64
+            result += 32;     // 4 DXT1 blocks = 8 * 4 = 32
+        }
+
+        if (numTailBlocks == 0)
+        {
+            continue;
+        }
+
+        // Narrower strip: replicate the last block to fill 16x4 pixels (never read outside of the region)
+        // and keep only the results of the valid blocks
+        for (uint32_t line = 0; line < 4; line++)
+        {
+            for (uint32_t block = 0; block < 4; block++)
+            {
+                const unsigned char* goofy_restrict blockLine = encoderPos + line * inputStride + (block < numTailBlocks ? block : numTailBlocks - 1) * 16;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    tailStrip[line * 64 + block * 16 + i] = blockLine[i];
+                }
+            }
+        }
+        goofySimdEncode<CODEC_TYPE>(tailStrip, 64, tailResult);
+        for (uint32_t i = 0; i < numTailBlocks * 8; i++)
+        {
+            result[i] = tailResult[i];
+        }
+    }
+    return 0;
+}
+
+int compressRegionDXT1(unsigned char* dst, unsigned int dstPitch, const unsigned char* src, unsigned int srcStride, unsigned int width, unsigned int height, unsigned int x,
+                       unsigned int y, unsigned int w, unsigned int h)
+{
+    return compressRegion<GOOFY_DXT1>(dst, dstPitch, src, srcStride, width, height, x, y, w, h);
+}
+
+int compressRegionETC1(unsigned char* dst, unsigned int dstPitch, const unsigned char* src, unsigned int srcStride, unsigned int width, unsigned int height, unsigned int x,
+                       unsigned int y, unsigned int w, unsigned int h)
+{
+    return compressRegion<GOOFY_ETC1>(dst, dstPitch, src, srcStride, width, height, x, y, w, h);
+}
+
+// Find the error threshold to select given percent of blocks with the largest error
+// (blocks with error equal to the threshold are all selected, so ties can add a few blocks over the budget)
+goofy_inline uint32_t findWorstBlocksThreshold(const uint32_t* errorMap, size_t numBlocks, unsigned int percent)
+{
+    const size_t budget = (numBlocks * percent + 99) / 100;
+    if (budget == 0)
+    {
+        return 0xFFFFFFFF;
+    }
+    if (budget >= numBlocks)
+    {
+        return 0;
+    }
+
+    // Coarse histogram (max block error is 16 * 128 * 128)
+    const uint32_t kBucketShift = 8;
+    const uint32_t kBucketSize = 1 << kBucketShift;
+    const uint32_t kLastBucket = (16 * 128 * 128) >> kBucketShift;
+    uint32_t histogram[kLastBucket + 1] = {};
+    for (size_t i = 0; i < numBlocks; i++)
+    {
+        uint32_t bucket = errorMap[i] >> kBucketShift;
+        histogram[bucket < kLastBucket ? bucket : kLastBucket]++;
+    }
+
+    // Take the worst buckets until the budget is reached, the last one (boundary bucket) is taken partially
+    size_t count = 0;
+    uint32_t boundaryBucket = kLastBucket;
+    for (;; boundaryBucket--)
+    {
+        if (count + histogram[boundaryBucket] >= budget || boundaryBucket == 0)
+        {
+            break;
+        }
+        count += histogram[boundaryBucket];
+    }
+
+    // Exact cutoff inside of the boundary bucket
+    uint32_t fineHistogram[kBucketSize] = {};
+    const uint32_t bucketStart = boundaryBucket << kBucketShift;
+    for (size_t i = 0; i < numBlocks; i++)
+    {
+        uint32_t bucket = errorMap[i] >> kBucketShift;
+        if ((bucket < kLastBucket ? bucket : kLastBucket) == boundaryBucket)
+        {
+            uint32_t offset = errorMap[i] - bucketStart;
+            fineHistogram[offset < kBucketSize ? offset : (kBucketSize - 1)]++;
+        }
+    }
+
+    for (uint32_t offset = kBucketSize - 1; offset > 0; offset--)
+    {
+        count += fineHistogram[offset];
+        if (count >= budget)
+        {
+            return bucketStart + offset;
+        }
+    }
+    return bucketStart;
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int compressHybrid(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap,
+                   EncodeBlockFunc encodeBlock, void* userData, uint32_t errorThreshold, unsigned int worstBlocksPercent)
+{
+    int res = compressWithErrorMap<CODEC_TYPE>(result, input, width, height, stride, errorMap);
+    if (res != 0)
+    {
+        return res;
+    }
+
+    unsigned int blockW = width >> 2;
+    unsigned int blockH = height >> 2;
+    if (worstBlocksPercent != 0)
+    {
+        errorThreshold = findWorstBlocksThreshold(errorMap, size_t(blockW) * size_t(blockH), worstBlocksPercent);
+    }
+
+    int numReencoded = 0;
+    unsigned char block[64];
+    for (uint32_t y = 0; y < blockH; y++)
+    {
+        for (uint32_t x = 0; x < blockW; x++)
+        {
+            if (errorMap[x] < errorThreshold)
+            {
+                continue;
+            }
+
+            const unsigned char* goofy_restrict blockPos = input + size_t(x) * 16;
+            for (uint32_t line = 0; line < 4; line++)
+            {
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    block[line * 16 + i] = blockPos[i];
+                }
+                blockPos += stride;
+            }
+            encodeBlock(result + size_t(x) * 8, block, userData);
+            numReencoded++;
+        }
+        input += size_t(stride) * 4; // 4 lines
+        result += size_t(blockW) * 8;
+        errorMap += blockW;
+    }
+    return numReencoded;
+}
+
+int compressDXT1Hybrid(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap,
+                       EncodeBlockFunc encodeBlock, void* userData, uint32_t errorThreshold, unsigned int worstBlocksPercent)
+{
+    return compressHybrid<GOOFY_DXT1>(result, input, width, height, stride, errorMap, encodeBlock, userData, errorThreshold, worstBlocksPercent);
+}
+
+int compressETC1Hybrid(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, unsigned int stride, uint32_t* errorMap,
+                       EncodeBlockFunc encodeBlock, void* userData, uint32_t errorThreshold, unsigned int worstBlocksPercent)
+{
+    return compressHybrid<GOOFY_ETC1>(result, input, width, height, stride, errorMap, encodeBlock, userData, errorThreshold, worstBlocksPercent);
+}
+
+//
+// Transcode 4 ETC1s blocks to DXT1 at once
+//
+goofy_inline void goofySimdTranscodeETC1sToDXT1(const unsigned char* goofy_restrict inputETC1s, unsigned char* goofy_restrict pResult)
+{
+    // Fetch four ETC1s blocks
+    // -----------------------------------------------------------
+
+    // bl0.rgbc | bl0.indices | bl1.rgbc | bl1.indices
+    // bl2.rgbc | bl2.indices | bl3.rgbc | bl3.indices
+    const uint8x16_t bl01 = simd::fetchUnaligned(inputETC1s);
+    const uint8x16_t bl23 = simd::fetchUnaligned(inputETC1s + 16);
+
+    // bl0.rgbc | bl2.rgbc | bl0.indices | bl2.indices
+    // bl1.rgbc | bl3.rgbc | bl1.indices | bl3.indices
+    const uint8x16x2_t blZip = simd::zipU4(bl01, bl23);
+
+    // R0 = bl0.rgbc | bl1.rgbc | bl2.rgbc | bl3.rgbc
+    // R1 = bl0.indices | bl1.indices | bl2.indices | bl3.indices
+    const uint8x16x2_t blocks = simd::zipU4(blZip.r0, blZip.r1);
+
+    // Endpoints (base color +/- large intensity modifier)
+    // -----------------------------------------------------------
+
+    // ETC1s base color is rgb555 (delta bits are zero), extend it to rgb888 the same way as ETC decoder does
+    // base0.rgb_ | base1.rgb_ | base2.rgb_ | base3.rgb_
+    const uint8x16_t blBase555 = simd::bit_and(blocks.r0, simd::fetch(&gConstEtcBaseColorMask));
+    const uint8x16_t blBaseColors = simd::bit_or(blBase555, simd::shiftRight<5>(blBase555));
+
+    // Large intensity modifier for every block (codeword 1 = control byte top 3 bits)
+    const uint64x2_t blControl = simd::getAsUInt64x2(blocks.r0);
+    goofy_align16(uint32_t modifiers[4]);
+    modifiers[0] = etc1LargeModifierRGB[(blControl.r0 >> 29ull) & 7];
+    modifiers[1] = etc1LargeModifierRGB[(blControl.r0 >> 61ull) & 7];
+    modifiers[2] = etc1LargeModifierRGB[(blControl.r1 >> 29ull) & 7];
+    modifiers[3] = etc1LargeModifierRGB[(blControl.r1 >> 61ull) & 7];
+    const uint8x16_t blModifiers = simd::fetch(&modifiers[0]);
+
+    // ETC decoder clamps every channel, saturated add/sub gives the same result
+    const uint8x16_t maxColors = simd::addsatu(blBaseColors, blModifiers);
+    const uint8x16_t minColors = simd::subsatu(blBaseColors, blModifiers);
+
+    // max555_0.rgba | min555_0.rgba | max555_1.rgba | min555_1.rgba
+    // max555_2.rgba | min555_2.rgba | max555_3.rgba | min555_3.rgba
+    const uint8x16x2_t maxMinColors555 = simd::zipU4(convertRgb888ToRgb555(maxColors), convertRgb888ToRgb555(minColors));
+    const uint64x2_t maxMin01 = simd::getAsUInt64x2(maxMinColors555.r0);
+    const uint64x2_t maxMin23 = simd::getAsUInt64x2(maxMinColors555.r1);
+
+    // Indices
+    // -----------------------------------------------------------
+
+    // ETC1 index bits are stored as two bit planes in the ETC pixel order (see transposeAs4x4x4)
+    //   lower 16 bits = MSB plane (1 = negative modifier)
+    //   upper 16 bits = LSB plane (1 = large modifier)
+    const uint64x2_t indices = simd::getAsUInt64x2(blocks.r1);
+
+    const uint8x16x4_t blNegMask = {simd::maskFromBits((uint32_t)(indices.r0)),
+                                    simd::maskFromBits((uint32_t)(indices.r0 >> 32ull)),
+                                    simd::maskFromBits((uint32_t)(indices.r1)),
+                                    simd::maskFromBits((uint32_t)(indices.r1 >> 32ull))};
+
+    const uint8x16x4_t blLargeMask = {simd::maskFromBits((uint32_t)(indices.r0 >> 16ull)),
+                                      simd::maskFromBits((uint32_t)(indices.r0 >> 48ull)),
+                                      simd::maskFromBits((uint32_t)(indices.r1 >> 16ull)),
+                                      simd::maskFromBits((uint32_t)(indices.r1 >> 48ull))};
+
+    // Back to the DXT pixel order (left-to-right, top-to-bottom)
+    const uint8x16x4_t blNegMaskTr = simd::transposeAs4x4x4Inverse(blNegMask);
+    const uint8x16x4_t blLargeMaskTr = simd::transposeAs4x4x4Inverse(blLargeMask);
+
+    // ETC modifier to DXT index
+    // -------------------------
+    //        +b(C0)      +a        -a       -b(C1)
+    // DEC: |    0    |    2    |    3    |    1    |
+    // BIN: |   00b   |   10b   |   11b   |   01b   |
+    //
+    //                          |      NegMask      |
+    //                |      ~LargeMask   |
+    //
+    // Neg0 | ~Large0 | Neg1 | ~Large1 | ...
+    const uint8x16x2_t bl0RawIndices = simd::zipB16(blNegMaskTr.r0, simd::bitnot(blLargeMaskTr.r0));
+    const uint8x16x2_t bl1RawIndices = simd::zipB16(blNegMaskTr.r1, simd::bitnot(blLargeMaskTr.r1));
+    const uint8x16x2_t bl2RawIndices = simd::zipB16(blNegMaskTr.r2, simd::bitnot(blLargeMaskTr.r2));
+    const uint8x16x2_t bl3RawIndices = simd::zipB16(blNegMaskTr.r3, simd::bitnot(blLargeMaskTr.r3));
+
+    const uint32_t bl0Indices = simd::moveMaskMSB(bl0RawIndices.r0) | (simd::moveMaskMSB(bl0RawIndices.r1) << 16);
+    const uint32_t bl1Indices = simd::moveMaskMSB(bl1RawIndices.r0) | (simd::moveMaskMSB(bl1RawIndices.r1) << 16);
+    const uint32_t bl2Indices = simd::moveMaskMSB(bl2RawIndices.r0) | (simd::moveMaskMSB(bl2RawIndices.r1) << 16);
+    const uint32_t bl3Indices = simd::moveMaskMSB(bl3RawIndices.r0) | (simd::moveMaskMSB(bl3RawIndices.r1) << 16);
+
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    pDest[0] = packDXT1Colors555(maxMin01.r0);
+    pDest[1] = bl0Indices;
+    pDest[2] = packDXT1Colors555(maxMin01.r1);
+    pDest[3] = bl1Indices;
+    pDest[4] = packDXT1Colors555(maxMin23.r0);
+    pDest[5] = bl2Indices;
+    pDest[6] = packDXT1Colors555(maxMin23.r1);
+    pDest[7] = bl3Indices;
+}
+
+int transcodeETC1sToDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    // those checks are required because of 4 blocks window inside the transcoder
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    // NOTE: Only ETC1s blocks can be transcoded precisely (single base color, both table codewords are the same).
+    //       For any other ETC1 block the base color and the intensity table of the first sub-block are used.
+    size_t numBlocks = size_t(width >> 2) * size_t(height >> 2);
+    for (size_t i = 0; i < numBlocks; i += 4)
+    {
+        goofySimdTranscodeETC1sToDXT1(input, result);
+        input += 32;  // 4 ETC1 blocks = 8 * 4 = 32
+        result += 32; // 4 DXT1 blocks = 8 * 4 = 32
+    }
+    return 0;
+}
+
+// Convert DXT1 color (rgb565) to rgb888, the same way as DXT1 decoder does
+goofy_inline uint32_t convertRgb565ToRgb888(uint32_t color)
+{
+    const uint32_t r = (color >> 11) & 0x1F;
+    const uint32_t g = (color >> 5) & 0x3F;
+    const uint32_t b = color & 0x1F;
+    return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16);
+}
+
+// Gather even bits of every 32-bit half to the lower 16 bits of that half
+//
+// x0y0x1y1x2y2...x15y15b -> 0000000000000000 x0x1x2...x15b
+goofy_inline uint64_t compactEvenBits(uint64_t v)
+{
+    v = v & 0x5555555555555555ull;
+    v = (v | (v >> 1ull)) & 0x3333333333333333ull;
+    v = (v | (v >> 2ull)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v >> 4ull)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v >> 8ull)) & 0x0000FFFF0000FFFFull;
+    return v;
+}
+
+//
+// Transcode 4 DXT1 blocks to ETC1s at once
+//
+goofy_inline void goofySimdTranscodeDXT1ToETC1s(const unsigned char* goofy_restrict inputDXT1, unsigned char* goofy_restrict pResult)
+{
+    // Fetch four DXT1 blocks
+    // -----------------------------------------------------------
+
+    // bl0.c0c1 | bl0.indices | bl1.c0c1 | bl1.indices
+    // bl2.c0c1 | bl2.indices | bl3.c0c1 | bl3.indices
+    const uint8x16_t bl01 = simd::fetchUnaligned(inputDXT1);
+    const uint8x16_t bl23 = simd::fetchUnaligned(inputDXT1 + 16);
+
+    // R0 = bl0.c0c1 | bl1.c0c1 | bl2.c0c1 | bl3.c0c1
+    // R1 = bl0.indices | bl1.indices | bl2.indices | bl3.indices
+    const uint8x16x2_t blZip = simd::zipU4(bl01, bl23);
+    const uint8x16x2_t blocks = simd::zipU4(blZip.r0, blZip.r1);
+
+    const uint64x2_t colors = simd::getAsUInt64x2(blocks.r0);
+    const uint64x2_t indices = simd::getAsUInt64x2(blocks.r1);
+
+    const uint32_t bl0c0 = (uint32_t)(colors.r0 & 0xFFFFull);
+    const uint32_t bl0c1 = (uint32_t)((colors.r0 >> 16ull) & 0xFFFFull);
+    const uint32_t bl1c0 = (uint32_t)((colors.r0 >> 32ull) & 0xFFFFull);
+    const uint32_t bl1c1 = (uint32_t)(colors.r0 >> 48ull);
+    const uint32_t bl2c0 = (uint32_t)(colors.r1 & 0xFFFFull);
+    const uint32_t bl2c1 = (uint32_t)((colors.r1 >> 16ull) & 0xFFFFull);
+    const uint32_t bl3c0 = (uint32_t)((colors.r1 >> 32ull) & 0xFFFFull);
+    const uint32_t bl3c1 = (uint32_t)(colors.r1 >> 48ull);
+
+    // Endpoints
+    // -----------------------------------------------------------
+
+    goofy_align16(uint32_t endpoints[8]);
+    endpoints[0] = convertRgb565ToRgb888(bl0c0);
+    endpoints[1] = convertRgb565ToRgb888(bl1c0);
+    endpoints[2] = convertRgb565ToRgb888(bl2c0);
+    endpoints[3] = convertRgb565ToRgb888(bl3c0);
+    endpoints[4] = convertRgb565ToRgb888(bl0c1);
+    endpoints[5] = convertRgb565ToRgb888(bl1c1);
+    endpoints[6] = convertRgb565ToRgb888(bl2c1);
+    endpoints[7] = convertRgb565ToRgb888(bl3c1);
+
+    // c0_0.rgba | c0_1.rgba | c0_2.rgba | c0_3.rgba
+    const uint8x16_t c0Colors = simd::fetch(&endpoints[0]);
+    // c1_0.rgba | c1_1.rgba | c1_2.rgba | c1_3.rgba
+    const uint8x16_t c1Colors = simd::fetch(&endpoints[4]);
+
+    // Endpoints brightness (see goofySimdEncode)
+    // c1_0.rr | c1_1.rr | c1_2.rr | c1_3.rr | c0_0.rr | c0_1.rr | c0_2.rr | c0_3.rr
+    // ...
+    const uint8x16x3_t blEndpointsDi = simd::deinterleaveRGB(simd::zipU4x2(c1Colors, c1Colors, c0Colors, c0Colors));
+    const uint8x16_t Y = simd::avg(simd::avg(blEndpointsDi.r0, blEndpointsDi.r2), blEndpointsDi.r1);
+
+    // R0 = c1_0.yyyy | c1_1.yyyy | c1_2.yyyy | c1_3.yyyy
+    // R1 = c0_0.yyyy | c0_1.yyyy | c0_2.yyyy | c0_3.yyyy
+    const uint8x16x2_t blEndpointsY = simd::zipB16(Y, Y);
+
+    // c1 is brighter than c0 (non zero if c1 brighter)
+    const uint8x16_t blC1BrighterY = simd::subsatu(blEndpointsY.r0, blEndpointsY.r1);
+    // range0.yyyy | range1.yyyy | range2.yyyy | range3.yyyy
+    const uint8x16_t blRangeY = simd::bit_or(simd::subsatu(blEndpointsY.r1, blEndpointsY.r0), blC1BrighterY);
+
+    // ETC1s base color is the color in the middle between the endpoints
+    const uint8x16_t baseColors555 = convertRgb888ToRgb555(simd::avg(c0Colors, c1Colors));
+    const uint64x2_t baseColors = simd::getAsUInt64x2(baseColors555);
+
+    // Indices
+    // -----------------------------------------------------------
+
+    // DXT index to ETC modifier
+    // -------------------------
+    //
+    //  4-color mode (c0 > c1)                         3-color mode (c0 <= c1)
+    //        C0       C2       C3       C1                  C0       C2       C3       C1
+    // BIN:  00b      10b      11b      01b            BIN:  00b      10b      11b      01b
+    // ETC:   +b       +a       -a       -b            ETC:   +b       +a       -b       -b
+    //
+    //  Negative modifier = lo bit (inverted if c1 is brighter than c0) or black color in 3-color mode
+    //  Large modifier = not hi bit or black color in 3-color mode
+    //
+    // lower 16 bits = block 0 (block 2), upper 16 bits = block 1 (block 3)
+    const uint64_t bl01Lo = compactEvenBits(indices.r0);
+    const uint64_t bl01Hi = compactEvenBits(indices.r0 >> 1ull);
+    const uint64_t bl23Lo = compactEvenBits(indices.r1);
+    const uint64_t bl23Hi = compactEvenBits(indices.r1 >> 1ull);
+
+    const uint64_t bl01Swap = (vector_get_by_index<0>(blC1BrighterY) != 0 ? 0xFFFFull : 0ull) | (vector_get_by_index<4>(blC1BrighterY) != 0 ? 0xFFFF00000000ull : 0ull);
+    const uint64_t bl23Swap = (vector_get_by_index<8>(blC1BrighterY) != 0 ? 0xFFFFull : 0ull) | (vector_get_by_index<12>(blC1BrighterY) != 0 ? 0xFFFF00000000ull : 0ull);
+    const uint64_t bl01ThreeColor = (bl0c0 <= bl0c1 ? 0xFFFFull : 0ull) | (bl1c0 <= bl1c1 ? 0xFFFF00000000ull : 0ull);
+    const uint64_t bl23ThreeColor = (bl2c0 <= bl2c1 ? 0xFFFFull : 0ull) | (bl3c0 <= bl3c1 ? 0xFFFF00000000ull : 0ull);
+
+    const uint64_t bl01Neg = (bl01Lo ^ bl01Swap) | (bl01Lo & bl01Hi & bl01ThreeColor);
+    const uint64_t bl23Neg = (bl23Lo ^ bl23Swap) | (bl23Lo & bl23Hi & bl23ThreeColor);
+    const uint64_t bl01Large = ~bl01Hi | (bl01Lo & bl01ThreeColor);
+    const uint64_t bl23Large = ~bl23Hi | (bl23Lo & bl23ThreeColor);
+
+    // Per pixel masks (DXT pixel order)
+    const uint8x16x4_t blNegMask = {simd::maskFromBits((uint32_t)(bl01Neg & 0xFFFFull)),
+                                    simd::maskFromBits((uint32_t)((bl01Neg >> 32ull) & 0xFFFFull)),
+                                    simd::maskFromBits((uint32_t)(bl23Neg & 0xFFFFull)),
+                                    simd::maskFromBits((uint32_t)((bl23Neg >> 32ull) & 0xFFFFull))};
+
+    const uint8x16x4_t blLargeMask = {simd::maskFromBits((uint32_t)(bl01Large & 0xFFFFull)),
+                                      simd::maskFromBits((uint32_t)((bl01Large >> 32ull) & 0xFFFFull)),
+                                      simd::maskFromBits((uint32_t)(bl23Large & 0xFFFFull)),
+                                      simd::maskFromBits((uint32_t)((bl23Large >> 32ull) & 0xFFFFull))};
+
+    // To the ETC pixel order (see goofySimdEncode)
+    const uint8x16x4_t blNegMaskTr = simd::transposeAs4x4x4(blNegMask);
+    const uint8x16x4_t blLargeMaskTr = simd::transposeAs4x4x4(blLargeMask);
+
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    pDest[0] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<0>(blRangeY)] | ((baseColors.r0 << 3ull) & 0xFFFFFF);
+    pDest[1] = simd::moveMaskMSB(blNegMaskTr.r0) | (simd::moveMaskMSB(blLargeMaskTr.r0) << 16);
+    pDest[2] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<4>(blRangeY)] | ((baseColors.r0 >> 29ull) & 0xFFFFFF);
+    pDest[3] = simd::moveMaskMSB(blNegMaskTr.r1) | (simd::moveMaskMSB(blLargeMaskTr.r1) << 16);
+    pDest[4] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<8>(blRangeY)] | ((baseColors.r1 << 3ull) & 0xFFFFFF);
+    pDest[5] = simd::moveMaskMSB(blNegMaskTr.r2) | (simd::moveMaskMSB(blLargeMaskTr.r2) << 16);
+    pDest[6] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<12>(blRangeY)] | ((baseColors.r1 >> 29ull) & 0xFFFFFF);
+    pDest[7] = simd::moveMaskMSB(blNegMaskTr.r3) | (simd::moveMaskMSB(blLargeMaskTr.r3) << 16);
+}
+
+int transcodeDXT1ToETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    // those checks are required because of 4 blocks window inside the transcoder
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    size_t numBlocks = size_t(width >> 2) * size_t(height >> 2);
+    for (size_t i = 0; i < numBlocks; i += 4)
+    {
+        goofySimdTranscodeDXT1ToETC1s(input, result);
+        input += 32;  // 4 DXT1 blocks = 8 * 4 = 32
+        result += 32; // 4 ETC1 blocks = 8 * 4 = 32
+    }
+    return 0;
+}
+
+// ETC1 small intensity modifiers (see etc1LargeModifierRGB)
+static const int32_t etc1SmallModifier[8] = {
+    2, 5, 9, 13, 18, 24, 33, 47
+};
+
+// Brightness of rgb888 color (the same approximation as goofySimdEncode uses)
+goofy_inline int32_t getBrightness888(uint32_t color)
+{
+    const uint32_t r = color & 0xFF;
+    const uint32_t g = (color >> 8) & 0xFF;
+    const uint32_t b = (color >> 16) & 0xFF;
+    return (int32_t)((((r + b + 1) >> 1) + g + 1) >> 1);
+}
+
+// Position of pixel index bit inside ETC1 index word (little endian, see goofySimdTranscodeETC1sToDXT1)
+goofy_inline uint32_t getEtcIndexBit(uint32_t x, uint32_t y)
+{
+    return (x * 4 + y) ^ 8;
+}
+
+// Sum of the 2x2 pixel quad weights of DXT1 block
+//
+// Pixel brightness * 3 = w * y(C0) + (3 - w) * y(C1), w = 3 (C0), 0 (C1), 2 (C2), 1 (C3) in 4-color mode
+// returns nibble per quad: qx0qy0 (bits 0..3) | qx1qy0 (bits 4..7) | qx0qy1 (bits 16..19) | qx1qy1 (bits 20..23)
+goofy_inline uint32_t getQuadWeightsDXT1(uint32_t indices)
+{
+    // w = hi bit ^ (lo bit ? 00b : 11b)
+    const uint32_t notLo = ~indices & 0x55555555;
+    const uint32_t w = ((indices >> 1) & 0x55555555) ^ (notLo | (notLo << 1));
+    // horizontal pairs (nibble per pair)
+    const uint32_t s = (w & 0x33333333) + ((w >> 2) & 0x33333333);
+    // vertical pairs
+    return (s & 0x00FF00FF) + ((s >> 8) & 0x00FF00FF);
+}
+
+// Number of set bits for every 2x2 pixel quad of ETC1 bit plane (see getEtcIndexBit)
+// returns byte per quad: qx0qy0 | qx1qy0 | qx0qy1 | qx1qy1
+goofy_inline uint32_t getQuadBitCountsETC1(uint32_t plane)
+{
+    // y0 + y1 | y2 + y3 (2-bit field per pair of pixels in the same column)
+    const uint32_t v = (plane & 0x5555) + ((plane >> 1) & 0x5555);
+    const uint32_t v0 = v & 0x3333;
+    const uint32_t v1 = (v >> 2) & 0x3333;
+    // neighboring columns, byte 0 = columns 2, 3, byte 1 = columns 0, 1
+    const uint32_t q0 = (v0 & 0x0F0F) + ((v0 >> 4) & 0x0F0F);
+    const uint32_t q1 = (v1 & 0x0F0F) + ((v1 >> 4) & 0x0F0F);
+    return (q0 >> 8) | ((q0 & 0xFF) << 8) | ((q1 >> 8) << 16) | ((q1 & 0xFF) << 24);
+}
+
+// Output block pixel for the quad of the parent block
+//
+//  parent0 | parent1
+//  --------+--------
+//  parent2 | parent3
+//
+goofy_inline uint32_t getMipPixel(uint32_t parentIndex, uint32_t quadIndex)
+{
+    return ((parentIndex >> 1) * 2 + (quadIndex >> 1)) * 4 + (parentIndex & 1) * 2 + (quadIndex & 1);
+}
+
+//
+// Build one DXT1 block from 2x2 DXT1 blocks
+//
+// The new endpoints are the bounding box of the parent endpoints (the same way as the encoder picks min/max colors),
+// the new indices are quantized from the parent palette brightness selected by the parent indices
+//
+goofy_inline void goofyMipDXT1(const unsigned char* goofy_restrict row0, const unsigned char* goofy_restrict row1, unsigned char* goofy_restrict pResult)
+{
+    const uint32_t* goofy_restrict parents[4] = {(const uint32_t*)row0, (const uint32_t*)(row0 + 8), (const uint32_t*)row1, (const uint32_t*)(row1 + 8)};
+
+    uint32_t maxColor = 0;
+    uint32_t minColor = 0xFFFFFF;
+    // brightness * 12 (3 for the palette, 4 for the quad)
+    int32_t quadSums[16];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const uint32_t c0 = parents[i][0] & 0xFFFF;
+        const uint32_t c1 = parents[i][0] >> 16;
+        const uint32_t indices = parents[i][1];
+
+        uint32_t hi = convertRgb565ToRgb888(c0);
+        uint32_t lo = convertRgb565ToRgb888(c1);
+        const int32_t y0 = getBrightness888(hi);
+        const int32_t y1 = getBrightness888(lo);
+
+        if (c0 > c1)
+        {
+            const uint32_t weights = getQuadWeightsDXT1(indices);
+            for (uint32_t q = 0; q < 4; q++)
+            {
+                const int32_t w = (int32_t)((weights >> ((q >> 1) * 16 + (q & 1) * 4)) & 0xF);
+                quadSums[getMipPixel(i, q)] = y1 * 12 + w * (y0 - y1);
+            }
+        }
+        else
+        {
+            // 3-color mode (C2 = (C0 + C1) / 2, C3 = black), never produced by Goofy
+            const int32_t palette[4] = {y0 * 3, y1 * 3, ((y0 + y1) * 3) >> 1, 0};
+            for (uint32_t q = 0; q < 4; q++)
+            {
+                const uint32_t p = (q >> 1) * 8 + (q & 1) * 2;
+                quadSums[getMipPixel(i, q)] = palette[(indices >> (p * 2)) & 3] + palette[(indices >> (p * 2 + 2)) & 3] +
+                                              palette[(indices >> (p * 2 + 8)) & 3] + palette[(indices >> (p * 2 + 10)) & 3];
+            }
+        }
+
+        if (y1 > y0)
+        {
+            const uint32_t tmp = hi;
+            hi = lo;
+            lo = tmp;
+        }
+
+        for (uint32_t ch = 0; ch < 24; ch += 8)
+        {
+            const uint32_t mask = 0xFFu << ch;
+            maxColor = ((hi & mask) > (maxColor & mask)) ? ((maxColor & ~mask) | (hi & mask)) : maxColor;
+            minColor = ((lo & mask) < (minColor & mask)) ? ((minColor & ~mask) | (lo & mask)) : minColor;
+        }
+    }
+
+    // Quantization thresholds (see goofySimdEncode)
+    const int32_t maxY = getBrightness888(maxColor);
+    const int32_t minY = getBrightness888(minColor);
+    const int32_t rangeY = (maxY - minY) > 8 ? (maxY - minY) : 8;
+    const int32_t mid12 = (maxY + minY) * 6;
+    const int32_t qt12 = (rangeY * 9) >> 1;
+
+    const uint32_t c0 = ((maxColor & 0xF8) << 8) | ((maxColor & 0xFC00) >> 5) | ((maxColor & 0xF80000) >> 19);
+    const uint32_t c1 = ((minColor & 0xF8) << 8) | ((minColor & 0xFC00) >> 5) | ((minColor & 0xF80000) >> 19);
+
+    //   gez & !lqt = 00b (C0), gez & lqt = 10b, !gez & lqt = 11b, !gez & !lqt = 01b (C1)
+    uint32_t indices = 0;
+    if (c0 != c1)
+    {
+        for (uint32_t p = 0; p < 16; p++)
+        {
+            const int32_t diff = quadSums[p] - mid12;
+            const uint32_t neg = diff < 0 ? 1 : 0;
+            const uint32_t lqt = (diff < 0 ? -diff : diff) < qt12 ? 2 : 0;
+            indices |= (neg | lqt) << (p * 2);
+        }
+    }
+
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    pDest[0] = c0 | (c1 << 16);
+    pDest[1] = indices;
+}
+
+//
+// Build one ETC1s block from 2x2 ETC1s blocks
+//
+// The new base color is the average of the parent base colors moved to the middle of the brightness range,
+// the intensity table and indices are quantized from the parent pixel brightness (base color +/- modifier)
+//
+goofy_inline void goofyMipETC1s(const unsigned char* goofy_restrict row0, const unsigned char* goofy_restrict row1, unsigned char* goofy_restrict pResult)
+{
+    const uint32_t* goofy_restrict parents[4] = {(const uint32_t*)row0, (const uint32_t*)(row0 + 8), (const uint32_t*)row1, (const uint32_t*)(row1 + 8)};
+
+    uint32_t sumR = 0;
+    uint32_t sumG = 0;
+    uint32_t sumB = 0;
+    // brightness * 4 (quad)
+    int32_t quadSums[16];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const uint32_t block = parents[i][0];
+        const uint32_t indices = parents[i][1];
+
+        // ETC1s base color is rgb555 (delta bits are zero)
+        const uint32_t r = (block >> 3) & 0x1F;
+        const uint32_t g = (block >> 11) & 0x1F;
+        const uint32_t b = (block >> 19) & 0x1F;
+        const uint32_t baseColor = ((r << 3) | (r >> 2)) | (((g << 3) | (g >> 2)) << 8) | (((b << 3) | (b >> 2)) << 16);
+        sumR += baseColor & 0xFF;
+        sumG += (baseColor >> 8) & 0xFF;
+        sumB += (baseColor >> 16) & 0xFF;
+
+        const int32_t baseY = getBrightness888(baseColor);
+        const uint32_t table = block >> 29;
+        const int32_t smallModifier = etc1SmallModifier[table];
+        const int32_t largeModifier = (int32_t)(etc1LargeModifierRGB[table] & 0xFF);
+
+        // Sum of modifiers = small * (#small - 2 * #negSmall) + large * (#large - 2 * #negLarge)
+        const uint32_t negPlane = indices & 0xFFFF;
+        const uint32_t largePlane = indices >> 16;
+        const uint32_t numLarge = getQuadBitCountsETC1(largePlane);
+        const uint32_t numNegSmall = getQuadBitCountsETC1(negPlane & ~largePlane);
+        const uint32_t numNegLarge = getQuadBitCountsETC1(negPlane & largePlane);
+        for (uint32_t q = 0; q < 4; q++)
+        {
+            const int32_t nl = (int32_t)((numLarge >> (q * 8)) & 0xFF);
+            const int32_t nns = (int32_t)((numNegSmall >> (q * 8)) & 0xFF);
+            const int32_t nnl = (int32_t)((numNegLarge >> (q * 8)) & 0xFF);
+            // NOTE: ETC decoder clamps every pixel, here only the sum is clamped
+            const int32_t sum = baseY * 4 + smallModifier * (4 - nl - nns * 2) + largeModifier * (nl - nnl * 2);
+            quadSums[getMipPixel(i, q)] = sum < 0 ? 0 : (sum > 1020 ? 1020 : sum);
+        }
+    }
+
+    int32_t minY4 = quadSums[0];
+    int32_t maxY4 = quadSums[0];
+    for (uint32_t p = 1; p < 16; p++)
+    {
+        minY4 = quadSums[p] < minY4 ? quadSums[p] : minY4;
+        maxY4 = quadSums[p] > maxY4 ? quadSums[p] : maxY4;
+    }
+
+    // Quantization thresholds (see goofySimdEncode)
+    int32_t rangeY = (maxY4 - minY4 + 2) >> 2;
+    rangeY = rangeY < 8 ? 8 : (rangeY > 255 ? 255 : rangeY);
+    const int32_t mid4 = (minY4 + maxY4 + 1) >> 1;
+    const int32_t qt4 = (rangeY * 3) >> 1;
+
+    // Move the average base color to the middle of the brightness range
+    const uint32_t avgColor = ((sumR + 2) >> 2) | (((sumG + 2) >> 2) << 8) | (((sumB + 2) >> 2) << 16);
+    const int32_t correction = ((mid4 + 2) >> 2) - getBrightness888(avgColor);
+
+    uint32_t baseColor555 = 0;
+    for (uint32_t ch = 0; ch < 24; ch += 8)
+    {
+        int32_t c = (int32_t)((avgColor >> ch) & 0xFF) + correction;
+        c = c < 0 ? 0 : (c > 255 ? 255 : c);
+        const uint32_t c5 = (uint32_t)(c + 4) >> 3;
+        baseColor555 |= (c5 > 31 ? 31 : c5) << (ch + 3);
+    }
+
+    //   neg = !gez, large = !lqt (see goofySimdEncode)
+    uint32_t indices = 0;
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            const int32_t diff = quadSums[y * 4 + x] - mid4;
+            const uint32_t bit = getEtcIndexBit(x, y);
+            const uint32_t neg = diff < 0 ? 1 : 0;
+            const uint32_t large = (diff < 0 ? -diff : diff) < qt4 ? 0 : 1;
+            indices |= (neg << bit) | (large << (bit + 16));
+        }
+    }
+
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    pDest[0] = etc1BrighnessRangeTocontrolByte[rangeY] | baseColor555;
+    pDest[1] = indices;
+}
+
+// convertRgb565ToRgb888 for every 16-bit lane, returns one channel per vector (r, g, b)
+goofy_inline uint8x16x3_t convertRgb565ToRgb888(const uint8x16_t& colors)
+{
+    const uint8x16_t r5 = simd::shiftRight16<11>(colors);
+    const uint8x16_t g6 = simd::bit_and(simd::shiftRight16<5>(colors), simd::fetch(&gConstWord6Bits));
+    const uint8x16_t b5 = simd::bit_and(colors, simd::fetch(&gConstWord5Bits));
+
+    uint8x16x3_t res;
+    res.r0 = simd::bit_or(simd::shiftLeft16<3>(r5), simd::shiftRight16<2>(r5));
+    res.r1 = simd::bit_or(simd::shiftLeft16<2>(g6), simd::shiftRight16<4>(g6));
+    res.r2 = simd::bit_or(simd::shiftLeft16<3>(b5), simd::shiftRight16<2>(b5));
+    return res;
+}
+
+// getQuadWeightsDXT1 for every 32-bit lane (DXT1 indices)
+// returns 16-bit lanes: qx0 weights (qy0 | qy1) in r0, qx1 weights (qy0 | qy1) in r1
+goofy_inline uint8x16x2_t getQuadWeightsDXT1(const uint8x16_t& indices)
+{
+    const uint8x16_t evenBits = simd::fetch(&gConstEvenBits);
+    const uint8x16_t bitPairs = simd::fetch(&gConstWordBitPairs);
+
+    // no bits cross the 16-bit lane boundary
+    const uint8x16_t notLo = simd::andnot(indices, evenBits);
+    const uint8x16_t w = simd::bit_xor(simd::bit_and(simd::shiftRight16<1>(indices), evenBits), simd::bit_or(notLo, simd::shiftLeft16<1>(notLo)));
+    const uint8x16_t s = simd::add16(simd::bit_and(w, bitPairs), simd::bit_and(simd::shiftRight16<2>(w), bitPairs));
+    // qx0 | qx1 << 4 (max 12 per nibble)
+    const uint8x16_t q = simd::add16(simd::bit_and(s, simd::fetch(&gConstWordLowByte)), simd::shiftRight16<8>(s));
+
+    uint8x16x2_t res;
+    res.r0 = simd::bit_and(q, simd::fetch(&gConstWordNibble));
+    res.r1 = simd::shiftRight16<4>(q);
+    return res;
+}
+
+// getQuadBitCountsETC1 for every 32-bit lane (the same ETC1 bit plane in both 16-bit lanes)
+// returns 16-bit lanes: qx0 counts (qy0 | qy1) in r0, qx1 counts (qy0 | qy1) in r1
+goofy_inline uint8x16x2_t getQuadBitCountsETC1(const uint8x16_t& planes)
+{
+    const uint8x16_t evenBits = simd::fetch(&gConstEvenBits);
+    const uint8x16_t bitPairs = simd::fetch(&gConstWordBitPairs);
+    const uint8x16_t nibbles = simd::fetch(&gConstWordNibbles);
+
+    const uint8x16_t v = simd::add16(simd::bit_and(planes, evenBits), simd::bit_and(simd::shiftRight16<1>(planes), evenBits));
+    // rows 0, 1 in the lower 16-bit lane, rows 2, 3 in the upper one
+    const uint8x16_t v01 = simd::bit_and(simd::select(simd::fetch(&gConstLowHalf), v, simd::shiftRight16<2>(v)), bitPairs);
+    // byte 0 = columns 2, 3, byte 1 = columns 0, 1
+    const uint8x16_t q = simd::add16(simd::bit_and(v01, nibbles), simd::bit_and(simd::shiftRight16<4>(v01), nibbles));
+
+    uint8x16x2_t res;
+    res.r0 = simd::shiftRight16<8>(q);
+    res.r1 = simd::bit_and(q, simd::fetch(&gConstWordLowByte));
+    return res;
+}
+
+// Reorder quad values of four output blocks to the output pixel order
+//
+// in: 16-bit lanes, parent i (see getMipPixel), one output block per 32-bit lane
+//
+// qx0[i] = | bl0.qy0 | bl0.qy1 | bl1.qy0 | bl1.qy1 | bl2.qy0 | bl2.qy1 | bl3.qy0 | bl3.qy1 |
+// qx1[i] = ...
+//
+// out: 16-bit lanes, r0..r3 = rows 0, 1 of the output blocks, r4..r7 = rows 2, 3 of the output blocks
+//
+goofy_inline void getMipRows(uint8x16_t* goofy_restrict rows, const uint8x16_t* goofy_restrict qx0, const uint8x16_t* goofy_restrict qx1)
+{
+    // bl0.qy0.qx0 | bl0.qy0.qx1 | bl0.qy1.qx0 | bl0.qy1.qx1 | bl1.qy0.qx0 | ...
+    const uint8x16x2_t p0 = simd::zipU2(qx0[0], qx1[0]);
+    const uint8x16x2_t p1 = simd::zipU2(qx0[1], qx1[1]);
+    const uint8x16x2_t p2 = simd::zipU2(qx0[2], qx1[2]);
+    const uint8x16x2_t p3 = simd::zipU2(qx0[3], qx1[3]);
+
+    const uint8x16x2_t top01 = simd::zipU4(p0.r0, p1.r0);
+    const uint8x16x2_t top23 = simd::zipU4(p0.r1, p1.r1);
+    const uint8x16x2_t bottom01 = simd::zipU4(p2.r0, p3.r0);
+    const uint8x16x2_t bottom23 = simd::zipU4(p2.r1, p3.r1);
+
+    rows[0] = top01.r0;
+    rows[1] = top01.r1;
+    rows[2] = top23.r0;
+    rows[3] = top23.r1;
+    rows[4] = bottom01.r0;
+    rows[5] = bottom01.r1;
+    rows[6] = bottom23.r0;
+    rows[7] = bottom23.r1;
+}
+
+// Replicate the 32-bit lane of every output block
+goofy_inline void replicateLanes(uint8x16_t* goofy_restrict res, const uint8x16_t& v)
+{
+    res[0] = simd::replicateU0000(v);
+    res[1] = simd::replicateU1111(v);
+    res[2] = simd::replicateU2222(v);
+    res[3] = simd::replicateU3333(v);
+}
+
+//
+// Build four DXT1 blocks from 2x2 DXT1 blocks each (the same result as four goofyMipDXT1 calls)
+//
+// row0/row1 - eight input blocks of the upper/lower input block row, pResult - four output blocks
+//
+goofy_inline void goofySimdMipDXT1(const unsigned char* goofy_restrict row0, const unsigned char* goofy_restrict row1, unsigned char* goofy_restrict pResult)
+{
+    const uint8x16_t evenLanes = simd::fetch(&gConstLowHalf);
+    const uint8x16_t zero = simd::zero();
+
+    // Fetch 2x8 DXT1 blocks
+    // -----------------------------------------------------------
+
+    // R0 = bl0.c0c1 | bl2.c0c1 | bl4.c0c1 | bl6.c0c1
+    // R1 = bl0.indices | bl2.indices | bl4.indices | bl6.indices
+    // R2 = bl1.c0c1 | bl3.c0c1 | bl5.c0c1 | bl7.c0c1
+    // R3 = bl1.indices | bl3.indices | bl5.indices | bl7.indices
+    const uint8x16x4_t top = {simd::fetchUnaligned(row0), simd::fetchUnaligned(row0 + 16), simd::fetchUnaligned(row0 + 32), simd::fetchUnaligned(row0 + 48)};
+    const uint8x16x4_t bottom = {simd::fetchUnaligned(row1), simd::fetchUnaligned(row1 + 16), simd::fetchUnaligned(row1 + 32), simd::fetchUnaligned(row1 + 48)};
+    const uint8x16x4_t topTr = simd::transposeAs4x4(top);
+    const uint8x16x4_t bottomTr = simd::transposeAs4x4(bottom);
+
+    // parent i of every output block (see getMipPixel)
+    const uint8x16_t parentColors[4] = {topTr.r0, topTr.r2, bottomTr.r0, bottomTr.r2};
+    const uint8x16_t parentIndices[4] = {topTr.r1, topTr.r3, bottomTr.r1, bottomTr.r3};
+
+    // Parent endpoints and quad brightness (16-bit lanes, c0 | c1 per output block)
+    // -----------------------------------------------------------
+
+    uint8x16_t maxR = zero;
+    uint8x16_t maxG = zero;
+    uint8x16_t maxB = zero;
+    uint8x16_t minR = simd::fetch(&gConstWordLowByte);
+    uint8x16_t minG = minR;
+    uint8x16_t minB = minR;
+    uint8x16_t fourColor = simd::bitnot(zero);
+    uint8x16_t quadsQx0[4];
+    uint8x16_t quadsQx1[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const uint8x16_t c = parentColors[i];
+        const uint8x16x3_t rgb = convertRgb565ToRgb888(c);
+        const uint8x16_t r = rgb.r0;
+        const uint8x16_t g = rgb.r1;
+        const uint8x16_t b = rgb.r2;
+
+        // y0 | y1 (see getBrightness888)
+        const uint8x16_t Y = simd::avg16(simd::avg16(r, b), g);
+        const uint8x16_t swappedY = simd::swapPairs16(Y);
+
+        // c0 > c1 (unsigned) in the lower lane, 3-color parents are handled by goofyMipDXT1
+        const uint8x16_t signedC = simd::add16(c, simd::fetch(&gConstWordSign));
+        fourColor = simd::bit_and(fourColor, simd::cmplt16(simd::swapPairs16(signedC), signedC));
+
+        // hi | lo (swap if c1 is brighter than c0)
+        const uint8x16_t c1Brighter = simd::cmplt16(Y, swappedY);
+        const uint8x16_t swapMask = simd::select(evenLanes, c1Brighter, simd::swapPairs16(c1Brighter));
+        const uint8x16_t hiLoR = simd::select(swapMask, simd::swapPairs16(r), r);
+        const uint8x16_t hiLoG = simd::select(swapMask, simd::swapPairs16(g), g);
+        const uint8x16_t hiLoB = simd::select(swapMask, simd::swapPairs16(b), b);
+        maxR = simd::max16(maxR, hiLoR);
+        maxG = simd::max16(maxG, hiLoG);
+        maxB = simd::max16(maxB, hiLoB);
+        minR = simd::min16(minR, hiLoR);
+        minG = simd::min16(minG, hiLoG);
+        minB = simd::min16(minB, hiLoB);
+
+        // brightness * 12 = y1 * 12 + w * (y0 - y1)
+        const uint8x16_t y0 = simd::select(evenLanes, Y, swappedY);
+        const uint8x16_t y1 = simd::select(evenLanes, swappedY, Y);
+        const uint8x16_t base = simd::mullo16(y1, simd::fetch(&gConstWordTwelve));
+        const uint8x16_t deltaY = simd::sub16(y0, y1);
+        const uint8x16x2_t weights = getQuadWeightsDXT1(parentIndices[i]);
+        quadsQx0[i] = simd::add16(base, simd::mullo16(weights.r0, deltaY));
+        quadsQx1[i] = simd::add16(base, simd::mullo16(weights.r1, deltaY));
+    }
+
+    // New endpoints (max | min) and quantization thresholds (see goofyMipDXT1)
+    // -----------------------------------------------------------
+
+    const uint8x16_t bbR = simd::select(evenLanes, maxR, minR);
+    const uint8x16_t bbG = simd::select(evenLanes, maxG, minG);
+    const uint8x16_t bbB = simd::select(evenLanes, maxB, minB);
+
+    // maxY | minY
+    const uint8x16_t bbY = simd::avg16(simd::avg16(bbR, bbB), bbG);
+    const uint8x16_t swappedBbY = simd::swapPairs16(bbY);
+    const uint8x16_t mid12 = simd::mullo16(simd::add16(bbY, swappedBbY), simd::fetch(&gConstWordSix));
+    const uint8x16_t deltaY = simd::sub16(bbY, swappedBbY);
+    const uint8x16_t rangeY = simd::max16(simd::max16(deltaY, simd::sub16(zero, deltaY)), simd::fetch(&gConstWordEight));
+    const uint8x16_t qt12 = simd::shiftRight16<1>(simd::mullo16(rangeY, simd::fetch(&gConstWordNine)));
+
+    // c0 | c1
+    const uint8x16_t endpoints565 = simd::bit_or(simd::bit_or(simd::shiftLeft16<11>(simd::shiftRight16<3>(bbR)),
+                                                              simd::shiftLeft16<5>(simd::shiftRight16<2>(bbG))),
+                                                 simd::shiftRight16<3>(bbB));
+
+    // Indices
+    // -----------------------------------------------------------
+
+    uint8x16_t rows[8];
+    getMipRows(rows, quadsQx0, quadsQx1);
+
+    uint8x16_t blMid12[4];
+    uint8x16_t blQt12[4];
+    replicateLanes(blMid12, mid12);
+    replicateLanes(blQt12, qt12);
+
+    //   gez & !lqt = 00b (C0), gez & lqt = 10b, !gez & lqt = 11b, !gez & !lqt = 01b (C1)
+    uint32_t indices[4];
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        const uint8x16_t diff01 = simd::sub16(rows[k], blMid12[k]);
+        const uint8x16_t diff23 = simd::sub16(rows[k + 4], blMid12[k]);
+        const uint8x16_t neg01 = simd::cmplt16(diff01, zero);
+        const uint8x16_t neg23 = simd::cmplt16(diff23, zero);
+        const uint8x16_t lqt01 = simd::cmplt16(simd::max16(diff01, simd::sub16(zero, diff01)), blQt12[k]);
+        const uint8x16_t lqt23 = simd::cmplt16(simd::max16(diff23, simd::sub16(zero, diff23)), blQt12[k]);
+
+        const uint8x16x2_t mask = simd::zipB16(simd::packs16(neg01, neg23), simd::packs16(lqt01, lqt23));
+        indices[k] = simd::moveMaskMSB(mask.r0) | (simd::moveMaskMSB(mask.r1) << 16);
+    }
+
+    goofy_align16(uint32_t endpoints[4]);
+    storeLanes(endpoints565, endpoints);
+
+    const uint32_t fourColorBits = simd::moveMaskMSB(fourColor);
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        if ((fourColorBits & (0x3u << (k * 4))) != (0x3u << (k * 4)))
+        {
+            goofyMipDXT1(row0 + k * 16, row1 + k * 16, pResult + k * 8);
+            continue;
+        }
+
+        pDest[k * 2] = endpoints[k];
+        pDest[k * 2 + 1] = (endpoints[k] & 0xFFFF) != (endpoints[k] >> 16) ? indices[k] : 0;
+    }
+}
+
+//
+// Build four ETC1s blocks from 2x2 ETC1s blocks each (the same result as four goofyMipETC1s calls)
+//
+// row0/row1 - eight input blocks of the upper/lower input block row, pResult - four output blocks
+//
+goofy_inline void goofySimdMipETC1s(const unsigned char* goofy_restrict row0, const unsigned char* goofy_restrict row1, unsigned char* goofy_restrict pResult)
+{
+    const uint8x16_t evenLanes = simd::fetch(&gConstLowHalf);
+    const uint8x16_t zero = simd::zero();
+    const uint8x16_t two = simd::fetch(&gConstWordTwo);
+    const uint8x16_t four = simd::fetch(&gConstWordFour);
+    const uint8x16_t lowByte = simd::fetch(&gConstWordLowByte);
+
+    // Fetch 2x8 ETC1s blocks
+    // -----------------------------------------------------------
+
+    // R0 = bl0.color | bl2.color | bl4.color | bl6.color
+    // R1 = bl0.indices | bl2.indices | bl4.indices | bl6.indices
+    // R2 = bl1.color | bl3.color | bl5.color | bl7.color
+    // R3 = bl1.indices | bl3.indices | bl5.indices | bl7.indices
+    const uint8x16x4_t top = {simd::fetchUnaligned(row0), simd::fetchUnaligned(row0 + 16), simd::fetchUnaligned(row0 + 32), simd::fetchUnaligned(row0 + 48)};
+    const uint8x16x4_t bottom = {simd::fetchUnaligned(row1), simd::fetchUnaligned(row1 + 16), simd::fetchUnaligned(row1 + 32), simd::fetchUnaligned(row1 + 48)};
+    const uint8x16x4_t topTr = simd::transposeAs4x4(top);
+    const uint8x16x4_t bottomTr = simd::transposeAs4x4(bottom);
+
+    // parent i of every output block (see getMipPixel)
+    const uint8x16_t parentColors[4] = {topTr.r0, topTr.r2, bottomTr.r0, bottomTr.r2};
+    const uint8x16_t parentIndices[4] = {topTr.r1, topTr.r3, bottomTr.r1, bottomTr.r3};
+
+    // Intensity modifiers of the parents (both 16-bit lanes of the output block)
+    goofy_align16(uint32_t smallModifiers[16]);
+    goofy_align16(uint32_t largeModifiers[16]);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const uint32_t* goofy_restrict parents = (const uint32_t*)((i >> 1) != 0 ? row1 : row0) + (i & 1) * 2;
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            const uint32_t table = parents[k * 4] >> 29;
+            smallModifiers[i * 4 + k] = uint32_t(etc1SmallModifier[table]) * 0x10001u;
+            largeModifiers[i * 4 + k] = (etc1LargeModifierRGB[table] & 0xFF) * 0x10001u;
+        }
+    }
+
+    // Parent base colors and quad brightness (16-bit lanes, lower | upper half of the block word per output block)
+    // -----------------------------------------------------------
+
+    const uint8x16_t maxSum = simd::fetch(&gConstWordMaxY4);
+    uint8x16_t sumRB = zero;
+    uint8x16_t sumG = zero;
+    uint8x16_t quadsQx0[4];
+    uint8x16_t quadsQx1[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const uint8x16_t block = parentColors[i];
+
+        // ETC1s base color is rgb555, r | b (bits 3..7 of both halves) and g (bits 11..15 of the lower half)
+        const uint8x16_t rb5 = simd::bit_and(simd::shiftRight16<3>(block), simd::fetch(&gConstWord5Bits));
+        const uint8x16_t g5 = simd::shiftRight16<11>(block);
+        const uint8x16_t rb = simd::bit_or(simd::shiftLeft16<3>(rb5), simd::shiftRight16<2>(rb5));
+        const uint8x16_t gg = simd::bit_or(simd::shiftLeft16<3>(g5), simd::shiftRight16<2>(g5));
+        const uint8x16_t g = simd::select(evenLanes, gg, simd::swapPairs16(gg));
+        sumRB = simd::add16(sumRB, rb);
+        sumG = simd::add16(sumG, g);
+
+        const uint8x16_t baseY = simd::avg16(simd::avg16(rb, simd::swapPairs16(rb)), g);
+        const uint8x16_t smallModifier = simd::fetch(&smallModifiers[i * 4]);
+        const uint8x16_t largeModifier = simd::fetch(&largeModifiers[i * 4]);
+
+        // neg plane | large plane to both halves
+        const uint8x16_t planes = parentIndices[i];
+        const uint8x16_t swappedPlanes = simd::swapPairs16(planes);
+        const uint8x16_t negPlane = simd::select(evenLanes, planes, swappedPlanes);
+        const uint8x16_t largePlane = simd::select(evenLanes, swappedPlanes, planes);
+        const uint8x16x2_t numLarge = getQuadBitCountsETC1(largePlane);
+        const uint8x16x2_t numNegSmall = getQuadBitCountsETC1(simd::andnot(largePlane, negPlane));
+        const uint8x16x2_t numNegLarge = getQuadBitCountsETC1(simd::bit_and(negPlane, largePlane));
+
+        // Sum of modifiers = small * (#small - 2 * #negSmall) + large * (#large - 2 * #negLarge), see goofyMipETC1s
+        const uint8x16_t base = simd::shiftLeft16<2>(baseY);
+        const uint8x16_t smallQx0 = simd::sub16(simd::sub16(four, numLarge.r0), simd::shiftLeft16<1>(numNegSmall.r0));
+        const uint8x16_t smallQx1 = simd::sub16(simd::sub16(four, numLarge.r1), simd::shiftLeft16<1>(numNegSmall.r1));
+        const uint8x16_t largeQx0 = simd::sub16(numLarge.r0, simd::shiftLeft16<1>(numNegLarge.r0));
+        const uint8x16_t largeQx1 = simd::sub16(numLarge.r1, simd::shiftLeft16<1>(numNegLarge.r1));
+        const uint8x16_t sumQx0 = simd::add16(simd::add16(base, simd::mullo16(smallModifier, smallQx0)), simd::mullo16(largeModifier, largeQx0));
+        const uint8x16_t sumQx1 = simd::add16(simd::add16(base, simd::mullo16(smallModifier, smallQx1)), simd::mullo16(largeModifier, largeQx1));
+        quadsQx0[i] = simd::min16(simd::max16(sumQx0, zero), maxSum);
+        quadsQx1[i] = simd::min16(simd::max16(sumQx1, zero), maxSum);
+    }
+
+    // Quantization thresholds and base color (see goofyMipETC1s)
+    // -----------------------------------------------------------
+
+    uint8x16_t minY4 = simd::min16(quadsQx0[0], quadsQx1[0]);
+    uint8x16_t maxY4 = simd::max16(quadsQx0[0], quadsQx1[0]);
+    for (uint32_t i = 1; i < 4; i++)
+    {
+        minY4 = simd::min16(minY4, simd::min16(quadsQx0[i], quadsQx1[i]));
+        maxY4 = simd::max16(maxY4, simd::max16(quadsQx0[i], quadsQx1[i]));
+    }
+    minY4 = simd::min16(minY4, simd::swapPairs16(minY4));
+    maxY4 = simd::max16(maxY4, simd::swapPairs16(maxY4));
+
+    const uint8x16_t rangeY = simd::min16(simd::max16(simd::shiftRight16<2>(simd::add16(simd::sub16(maxY4, minY4), two)), simd::fetch(&gConstWordEight)), lowByte);
+    const uint8x16_t mid4 = simd::shiftRight16<1>(simd::add16(simd::add16(minY4, maxY4), simd::fetch(&gConstWordOne)));
+    const uint8x16_t qt4 = simd::shiftRight16<1>(simd::mullo16(rangeY, simd::fetch(&gConstWordThree)));
+
+    // Move the average base color to the middle of the brightness range
+    const uint8x16_t avgRB = simd::shiftRight16<2>(simd::add16(sumRB, two));
+    const uint8x16_t avgG = simd::shiftRight16<2>(simd::add16(sumG, two));
+    const uint8x16_t avgY = simd::avg16(simd::avg16(avgRB, simd::swapPairs16(avgRB)), avgG);
+    const uint8x16_t correction = simd::sub16(simd::shiftRight16<2>(simd::add16(mid4, two)), avgY);
+
+    const uint8x16_t max5 = simd::fetch(&gConstWord5Bits);
+    const uint8x16_t rb = simd::min16(simd::max16(simd::add16(avgRB, correction), zero), lowByte);
+    const uint8x16_t g = simd::min16(simd::max16(simd::add16(avgG, correction), zero), lowByte);
+    const uint8x16_t rb5 = simd::min16(simd::shiftRight16<3>(simd::add16(rb, four)), max5);
+    const uint8x16_t g5 = simd::min16(simd::shiftRight16<3>(simd::add16(g, four)), max5);
+    const uint8x16_t baseColors555 = simd::bit_or(simd::shiftLeft16<3>(rb5), simd::bit_and(simd::shiftLeft16<11>(g5), evenLanes));
+
+    // Indices
+    // -----------------------------------------------------------
+
+    uint8x16_t rows[8];
+    getMipRows(rows, quadsQx0, quadsQx1);
+
+    uint8x16_t blMid4[4];
+    uint8x16_t blQt4[4];
+    replicateLanes(blMid4, mid4);
+    replicateLanes(blQt4, qt4);
+
+    //   neg = !gez, large = !lqt (see goofySimdEncode)
+    uint8x16x4_t blNegMask;
+    uint8x16x4_t blLargeMask;
+    uint8x16_t* negMasks[4] = {&blNegMask.r0, &blNegMask.r1, &blNegMask.r2, &blNegMask.r3};
+    uint8x16_t* largeMasks[4] = {&blLargeMask.r0, &blLargeMask.r1, &blLargeMask.r2, &blLargeMask.r3};
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        const uint8x16_t diff01 = simd::sub16(rows[k], blMid4[k]);
+        const uint8x16_t diff23 = simd::sub16(rows[k + 4], blMid4[k]);
+        const uint8x16_t lqt01 = simd::cmplt16(simd::max16(diff01, simd::sub16(zero, diff01)), blQt4[k]);
+        const uint8x16_t lqt23 = simd::cmplt16(simd::max16(diff23, simd::sub16(zero, diff23)), blQt4[k]);
+        *negMasks[k] = simd::packs16(simd::cmplt16(diff01, zero), simd::cmplt16(diff23, zero));
+        *largeMasks[k] = simd::bitnot(simd::packs16(lqt01, lqt23));
+    }
+
+    // To the ETC pixel order
+    const uint8x16x4_t blNegMaskTr = simd::transposeAs4x4x4(blNegMask);
+    const uint8x16x4_t blLargeMaskTr = simd::transposeAs4x4x4(blLargeMask);
+
+    goofy_align16(uint32_t baseColors[4]);
+    storeLanes(baseColors555, baseColors);
+
+    uint32_t* goofy_restrict pDest = (uint32_t* goofy_restrict)pResult;
+    pDest[0] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<0>(rangeY)] | baseColors[0];
+    pDest[1] = simd::moveMaskMSB(blNegMaskTr.r0) | (simd::moveMaskMSB(blLargeMaskTr.r0) << 16);
+    pDest[2] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<4>(rangeY)] | baseColors[1];
+    pDest[3] = simd::moveMaskMSB(blNegMaskTr.r1) | (simd::moveMaskMSB(blLargeMaskTr.r1) << 16);
+    pDest[4] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<8>(rangeY)] | baseColors[2];
+    pDest[5] = simd::moveMaskMSB(blNegMaskTr.r2) | (simd::moveMaskMSB(blLargeMaskTr.r2) << 16);
+    pDest[6] = etc1BrighnessRangeTocontrolByte[vector_get_by_index<12>(rangeY)] | baseColors[3];
+    pDest[7] = simd::moveMaskMSB(blNegMaskTr.r3) | (simd::moveMaskMSB(blLargeMaskTr.r3) << 16);
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int generateMip(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    // every output block is made from 2x2 input blocks
+    if (width % 8 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 8 != 0)
+    {
+        return -2;
+    }
+
+    const size_t inputPitch = size_t(width >> 2) * 8;
+    for (unsigned int y = 0; y < height; y += 8)
+    {
+        const unsigned char* row0 = input + size_t(y >> 2) * inputPitch;
+        const unsigned char* row1 = row0 + inputPitch;
+        unsigned int x = 0;
+        for (; x + 32 <= width; x += 32)
+        {
+            if (CODEC_TYPE == GOOFY_DXT1)
+            {
+                goofySimdMipDXT1(row0, row1, result);
+            }
+            else
+            {
+                goofySimdMipETC1s(row0, row1, result);
+            }
+            row0 += 64; // 8 input blocks = 8 * 8 = 64
+            row1 += 64;
+            result += 32; // 4 output blocks = 8 * 4 = 32
+        }
+
+        // the rest of the row (up to 3 output blocks)
+        for (; x < width; x += 8)
+        {
+            if (CODEC_TYPE == GOOFY_DXT1)
+            {
+                goofyMipDXT1(row0, row1, result);
+            }
+            else
+            {
+                goofyMipETC1s(row0, row1, result);
+            }
+            row0 += 16; // 2 input blocks = 8 * 2 = 16
+            row1 += 16;
+            result += 8;
+        }
+    }
+    return 0;
+}
+
+int generateMipDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    return generateMip<GOOFY_DXT1>(result, input, width, height);
+}
+
+int generateMipETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    return generateMip<GOOFY_ETC1>(result, input, width, height);
+}
+
+// Transpose pixel indices of 4 blocks (x <-> y)
+//
+// DXT1: 2-bit index of pixel (x, y) at bit (y * 4 + x) * 2
+// ETC1: two 16-bit planes, bit of pixel (x, y) at (x * 4 + y) ^ 8 (see getEtcIndexBit)
+template<GoofyCodecType CODEC_TYPE>
+goofy_inline uint8x16_t transposeIndices(const uint8x16_t& indices)
+{
+    if (CODEC_TYPE == GOOFY_DXT1)
+    {
+        // swap top-right and bottom-left 2x2 quads, then top-right and bottom-left pixels inside every quad
+        return simd::deltaSwap<6, 0x00CC00CC>(simd::deltaSwap<12, 0x0000F0F0>(indices));
+    }
+    else
+    {
+        // the same for the column-major bit planes (bytes are swapped to get x * 4 + y bit order and back)
+        const uint8x16_t v = simd::deltaSwap<8, 0x00FF00FF>(indices);
+        return simd::deltaSwap<8, 0x00FF00FF>(simd::deltaSwap<3, 0x0A0A0A0A>(simd::deltaSwap<6, 0x00CC00CC>(v)));
+    }
+}
+
+// Mirror pixel indices of 4 blocks left-right (x -> 3 - x)
+template<GoofyCodecType CODEC_TYPE>
+goofy_inline uint8x16_t flipIndicesX(const uint8x16_t& indices)
+{
+    if (CODEC_TYPE == GOOFY_DXT1)
+    {
+        // reverse 2-bit indices inside every row (byte)
+        return simd::deltaSwap<2, 0x0C0C0C0C>(simd::deltaSwap<6, 0x03030303>(indices));
+    }
+    else
+    {
+        // reverse columns (nibbles) inside every plane, stored column is x ^ 2
+        return simd::deltaSwap<4, 0x00F000F0>(simd::deltaSwap<12, 0x000F000F>(indices));
+    }
+}
+
+// Mirror pixel indices of 4 blocks top-bottom (y -> 3 - y)
+template<GoofyCodecType CODEC_TYPE>
+goofy_inline uint8x16_t flipIndicesY(const uint8x16_t& indices)
+{
+    if (CODEC_TYPE == GOOFY_DXT1)
+    {
+        // reverse rows (bytes)
+        return simd::deltaSwap<8, 0x0000FF00>(simd::deltaSwap<24, 0x000000FF>(indices));
+    }
+    else
+    {
+        // reverse bits inside every column (nibble)
+        return simd::deltaSwap<1, 0x22222222>(simd::deltaSwap<3, 0x11111111>(indices));
+    }
+}
+
+template<GoofyCodecType CODEC_TYPE, GoofyTransform TRANSFORM>
+goofy_inline uint8x16_t transformIndices(const uint8x16_t& indices)
+{
+    switch (TRANSFORM)
+    {
+    case GOOFY_FLIP_X:
+        return flipIndicesX<CODEC_TYPE>(indices);
+    case GOOFY_FLIP_Y:
+        return flipIndicesY<CODEC_TYPE>(indices);
+    case GOOFY_ROTATE_90_CW:
+        return flipIndicesX<CODEC_TYPE>(transposeIndices<CODEC_TYPE>(indices));
+    case GOOFY_ROTATE_180:
+        return flipIndicesY<CODEC_TYPE>(flipIndicesX<CODEC_TYPE>(indices));
+    default:
+        return flipIndicesY<CODEC_TYPE>(transposeIndices<CODEC_TYPE>(indices));
+    }
+}
+
+//
+// Transform 4 DXT1/ETC1s blocks at once and store them to the transformed positions
+//
+template<GoofyCodecType CODEC_TYPE, GoofyTransform TRANSFORM>
+goofy_inline void goofySimdTransform(const unsigned char* goofy_restrict input, uint64_t* goofy_restrict pResult, size_t x, size_t y, size_t numBlocksX, size_t numBlocksY)
+{
+    // bl0.colors | bl0.indices | bl1.colors | bl1.indices
+    // bl2.colors | bl2.indices | bl3.colors | bl3.indices
+    const uint8x16_t bl01 = simd::fetchUnaligned(input);
+    const uint8x16_t bl23 = simd::fetchUnaligned(input + 16);
+
+    // R0 = bl0.colors | bl1.colors | bl2.colors | bl3.colors
+    // R1 = bl0.indices | bl1.indices | bl2.indices | bl3.indices
+    const uint8x16x2_t blZip = simd::zipU4(bl01, bl23);
+    const uint8x16x2_t blocks = simd::zipU4(blZip.r0, blZip.r1);
+
+    // Back to the block order
+    const uint8x16x2_t res = simd::zipU4(blocks.r0, transformIndices<CODEC_TYPE, TRANSFORM>(blocks.r1));
+    const uint64x2_t res01 = simd::getAsUInt64x2(res.r0);
+    const uint64x2_t res23 = simd::getAsUInt64x2(res.r1);
+    const uint64_t bl[4] = {res01.r0, res01.r1, res23.r0, res23.r1};
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        const size_t sx = x + i;
+        switch (TRANSFORM)
+        {
+        case GOOFY_FLIP_X:
+            pResult[y * numBlocksX + (numBlocksX - 1 - sx)] = bl[i];
+            break;
+        case GOOFY_FLIP_Y:
+            pResult[(numBlocksY - 1 - y) * numBlocksX + sx] = bl[i];
+            break;
+        case GOOFY_ROTATE_90_CW:
+            pResult[sx * numBlocksY + (numBlocksY - 1 - y)] = bl[i];
+            break;
+        case GOOFY_ROTATE_180:
+            pResult[(numBlocksY - 1 - y) * numBlocksX + (numBlocksX - 1 - sx)] = bl[i];
+            break;
+        default:
+            pResult[(numBlocksX - 1 - sx) * numBlocksY + y] = bl[i];
+            break;
+        }
+    }
+}
+
+template<GoofyCodecType CODEC_TYPE, GoofyTransform TRANSFORM>
+void transformImage(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height)
+{
+    const size_t numBlocksX = width >> 2;
+    const size_t numBlocksY = height >> 2;
+    for (size_t y = 0; y < numBlocksY; y++)
+    {
+        for (size_t x = 0; x < numBlocksX; x += 4)
+        {
+            goofySimdTransform<CODEC_TYPE, TRANSFORM>(input, (uint64_t*)result, x, y, numBlocksX, numBlocksY);
+            input += 32; // 4 blocks = 8 * 4 = 32
+        }
+    }
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int transform(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, GoofyTransform transform)
+{
+    // those checks are required because of 4 blocks window inside the transform
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    switch (transform)
+    {
+    case GOOFY_FLIP_X:
+        transformImage<CODEC_TYPE, GOOFY_FLIP_X>(result, input, width, height);
+        break;
+    case GOOFY_FLIP_Y:
+        transformImage<CODEC_TYPE, GOOFY_FLIP_Y>(result, input, width, height);
+        break;
+    case GOOFY_ROTATE_90_CW:
+        transformImage<CODEC_TYPE, GOOFY_ROTATE_90_CW>(result, input, width, height);
+        break;
+    case GOOFY_ROTATE_180:
+        transformImage<CODEC_TYPE, GOOFY_ROTATE_180>(result, input, width, height);
+        break;
+    case GOOFY_ROTATE_90_CCW:
+        transformImage<CODEC_TYPE, GOOFY_ROTATE_90_CCW>(result, input, width, height);
+        break;
+    default:
+        return -3;
+    }
+    return 0;
+}
+
+int transformDXT1(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, GoofyTransform transform)
+{
+    return goofy::transform<GOOFY_DXT1>(result, input, width, height, transform);
+}
+
+// NOTE: Only ETC1s blocks can be transformed this way (both sub-blocks share the base color and the table codeword)
+int transformETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, GoofyTransform transform)
+{
+    return goofy::transform<GOOFY_ETC1>(result, input, width, height, transform);
+}
+
+int copyBlocks(unsigned char* dst, unsigned int dstWidth, unsigned int dstX, unsigned int dstY, const unsigned char* src, unsigned int srcWidth, unsigned int srcX,
+               unsigned int srcY, unsigned int width, unsigned int height)
+{
+    if (dstWidth % 4 != 0 || dstX % 4 != 0 || srcWidth % 4 != 0 || srcX % 4 != 0 || width % 4 != 0)
+    {
+        return -1;
+    }
+
+    if (dstY % 4 != 0 || srcY % 4 != 0 || height % 4 != 0)
+    {
+        return -2;
+    }
+
+    // DXT1 and ETC1 blocks are 8 bytes
+    const size_t dstPitch = size_t(dstWidth >> 2);
+    const size_t srcPitch = size_t(srcWidth >> 2);
+    uint64_t* goofy_restrict pDst = (uint64_t*)dst + size_t(dstY >> 2) * dstPitch + (dstX >> 2);
+    const uint64_t* goofy_restrict pSrc = (const uint64_t*)src + size_t(srcY >> 2) * srcPitch + (srcX >> 2);
+    const size_t numBlocksX = width >> 2;
+    for (unsigned int y = 0; y < height; y += 4)
+    {
+        for (size_t x = 0; x < numBlocksX; x++)
+        {
+            pDst[x] = pSrc[x];
+        }
+        pDst += dstPitch;
+        pSrc += srcPitch;
+    }
+    return 0;
+}
+
+//
+// Adjust base colors of 4 ETC1s blocks at once
+//
+goofy_inline void goofySimdAdjustColorETC1s(const unsigned char* input, unsigned char* pResult, const uint8x16_t& scale,
+                                            const uint8x16_t& offsetPos, const uint8x16_t& offsetNeg)
+{
+    // bl0.rgbc | bl0.indices | bl1.rgbc | bl1.indices
+    // bl2.rgbc | bl2.indices | bl3.rgbc | bl3.indices
+    const uint8x16_t bl01 = simd::fetchUnaligned(input);
+    const uint8x16_t bl23 = simd::fetchUnaligned(input + 16);
+
+    // R0 = bl0.rgbc | bl1.rgbc | bl2.rgbc | bl3.rgbc
+    // R1 = bl0.indices | bl1.indices | bl2.indices | bl3.indices
+    const uint8x16x2_t blZip = simd::zipU4(bl01, bl23);
+    const uint8x16x2_t blocks = simd::zipU4(blZip.r0, blZip.r1);
+
+    // ETC1s base color is rgb555 (delta bits are zero), extend it to rgb888 the same way as ETC decoder does
+    const uint8x16_t baseColorMask = simd::fetch(&gConstEtcBaseColorMask);
+    const uint8x16_t blBase555 = simd::bit_and(blocks.r0, baseColorMask);
+    const uint8x16_t blBaseColors = simd::bit_or(blBase555, simd::shiftRight<5>(blBase555));
+
+    // Scale and offset with saturation
+    const uint8x16_t blAdjusted = simd::subsatu(simd::addsatu(simd::scaleU8(blBaseColors, scale), offsetPos), offsetNeg);
+
+    // Round to rgb555 and keep the control byte
+    // c - (c >> 5) maps 0..255 to 0..248 (exact inverse of the rgb555 extension above), +4 and drop 3 low bits to round
+    const uint8x16_t blAdjusted248 = simd::subsatu(blAdjusted, simd::shiftRight<5>(blAdjusted));
+    const uint8x16_t blAdjusted555 = simd::bit_and(simd::addsatu(blAdjusted248, simd::fetch(&gConstFour)), baseColorMask);
+    const uint8x16_t blColors = simd::bit_or(blAdjusted555, simd::andnot(baseColorMask, blocks.r0));
+
+    // Back to the block order
+    const uint8x16x2_t res = simd::zipU4(blColors, blocks.r1);
+    const uint64x2_t res01 = simd::getAsUInt64x2(res.r0);
+    const uint64x2_t res23 = simd::getAsUInt64x2(res.r1);
+
+    // NOTE: no restrict here, the result can be the same as input
+    uint64_t* pDest = (uint64_t*)pResult;
+    pDest[0] = res01.r0;
+    pDest[1] = res01.r1;
+    pDest[2] = res23.r0;
+    pDest[3] = res23.r1;
+}
+
+int adjustColorETC1s(unsigned char* result, const unsigned char* input, unsigned int width, unsigned int height, const unsigned int scaleRGB[3], const int offsetRGB[3])
+{
+    // those checks are required because of 4 blocks window
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    // scale: rgb_ as 16-bit values (8.8 fixed point), offset: positive and negative parts per channel (rgb_ x 4)
+    goofy_align16(uint16_t scale[8]);
+    goofy_align16(uint8_t offsetPos[16]);
+    goofy_align16(uint8_t offsetNeg[16]);
+    for (int i = 0; i < 16; i++)
+    {
+        const int ch = i & 3;
+        const int offset = (ch == 3) ? 0 : offsetRGB[ch];
+        offsetPos[i] = (uint8_t)(offset > 0 ? (offset > 255 ? 255 : offset) : 0);
+        offsetNeg[i] = (uint8_t)(offset < 0 ? (offset < -255 ? 255 : -offset) : 0);
+        if (i < 8)
+        {
+            scale[i] = (uint16_t)((ch == 3) ? 256 : (scaleRGB[ch] > 1024 ? 1024 : scaleRGB[ch]));
+        }
+    }
+
+    const uint8x16_t blScale = simd::fetch(&scale[0]);
+    const uint8x16_t blOffsetPos = simd::fetch(&offsetPos[0]);
+    const uint8x16_t blOffsetNeg = simd::fetch(&offsetNeg[0]);
+
+    size_t numBlocks = size_t(width >> 2) * size_t(height >> 2);
+    for (size_t i = 0; i < numBlocks; i += 4)
+    {
+        goofySimdAdjustColorETC1s(input, result, blScale, blOffsetPos, blOffsetNeg);
+        input += 32;  // 4 ETC1 blocks = 8 * 4 = 32
+        result += 32;
+    }
+    return 0;
+}
+
+//
+// Selector population counts of 4 DXT1/ETC1s blocks at once
+//
+// counts[entry * 4 + block], colors[block] = first 32 bits of the block
+//   DXT1 palette entries: C0, C1, C2, C3 (index value)
+//   ETC1 palette entries: +small, +large, -small, -large
+//
+template<GoofyCodecType CODEC_TYPE>
+goofy_inline void goofySimdSelectorCounts(const unsigned char* goofy_restrict input, uint32_t* goofy_restrict counts, uint32_t* goofy_restrict colors)
+{
+    // bl0.colors | bl0.indices | bl1.colors | bl1.indices
+    // bl2.colors | bl2.indices | bl3.colors | bl3.indices
+    const uint8x16_t bl01 = simd::fetchUnaligned(input);
+    const uint8x16_t bl23 = simd::fetchUnaligned(input + 16);
+
+    // R0 = bl0.colors | bl1.colors | bl2.colors | bl3.colors
+    // R1 = bl0.indices | bl1.indices | bl2.indices | bl3.indices
+    const uint8x16x2_t blZip = simd::zipU4(bl01, bl23);
+    const uint8x16x2_t blocks = simd::zipU4(blZip.r0, blZip.r1);
+    storeLanes(blocks.r0, colors);
+
+    if (CODEC_TYPE == GOOFY_DXT1)
+    {
+        // lo/hi bits of 2-bit indices
+        const uint8x16_t evenBits = simd::fetch(&gConstEvenBits);
+        const uint8x16_t lo = simd::bit_and(blocks.r1, evenBits);
+        const uint8x16_t hi = simd::bit_and(simd::shiftRight<1>(blocks.r1), evenBits);
+
+        // 01b = C1, 10b = C2, 11b = C3
+        storeLanes(simd::popcount32(simd::andnot(hi, lo)), counts + 4);
+        storeLanes(simd::popcount32(simd::andnot(lo, hi)), counts + 8);
+        storeLanes(simd::popcount32(simd::bit_and(lo, hi)), counts + 12);
+        for (int i = 0; i < 4; i++)
+        {
+            counts[i] = 16 - counts[4 + i] - counts[8 + i] - counts[12 + i];
+        }
+    }
+    else
+    {
+        // lower 16 bits = MSB plane (1 = negative modifier), upper 16 bits = LSB plane (1 = large modifier)
+        const uint8x16_t lowHalf = simd::fetch(&gConstLowHalf);
+        const uint8x16_t negPlane = simd::bit_and(blocks.r1, lowHalf);
+        const uint8x16_t largePlaneSwapped = simd::deltaSwap<16, 0x0000FFFF>(blocks.r1);
+
+        goofy_align16(uint32_t numNeg[4]);
+        goofy_align16(uint32_t numLarge[4]);
+        storeLanes(simd::popcount32(negPlane), numNeg);
+        storeLanes(simd::popcount32(simd::andnot(lowHalf, blocks.r1)), numLarge);
+        storeLanes(simd::popcount32(simd::bit_and(negPlane, largePlaneSwapped)), counts + 12);
+        for (int i = 0; i < 4; i++)
+        {
+            counts[8 + i] = numNeg[i] - counts[12 + i];
+            counts[4 + i] = numLarge[i] - counts[12 + i];
+            counts[i] = 16 - numNeg[i] - counts[4 + i];
+        }
+    }
+}
+
+// Colors for SWAR arithmetic: 21 bits per channel (r | g << 21 | b << 42)
+static const uint64_t kWideOnes = 1ull | (1ull << 21ull) | (1ull << 42ull);
+
+goofy_inline uint64_t convertRgb888ToWide(uint32_t c)
+{
+    return uint64_t(c & 0xFF) | (uint64_t((c >> 8) & 0xFF) << 21ull) | (uint64_t((c >> 16) & 0xFF) << 42ull);
+}
+
+goofy_inline uint32_t convertWideToRgb888(uint64_t w)
+{
+    return uint32_t(w & 0xFF) | (uint32_t((w >> 21ull) & 0xFF) << 8) | (uint32_t((w >> 42ull) & 0xFF) << 16);
+}
+
+// Per channel min/max (a, b <= 0xFFFFF per channel): bit 20 of (a | bit20) - b is set if a >= b
+goofy_inline uint64_t getWideGreaterOrEqualMask(uint64_t a, uint64_t b)
+{
+    return (((a | (kWideOnes << 20ull)) - b) >> 20ull & kWideOnes) * 0x1FFFFFull;
+}
+
+goofy_inline uint64_t minWide(uint64_t a, uint64_t b)
+{
+    const uint64_t ge = getWideGreaterOrEqualMask(a, b);
+    return (b & ge) | (a & ~ge);
+}
+
+goofy_inline uint64_t maxWide(uint64_t a, uint64_t b)
+{
+    const uint64_t ge = getWideGreaterOrEqualMask(a, b);
+    return (a & ge) | (b & ~ge);
+}
+
+// Palettes of 4 blocks (the same way as DXT1/ETC decoders do), one channel per vector (r, g, b), 16-bit lanes
+//
+// entries01 = | bl0.e0 | bl0.e1 | bl1.e0 | bl1.e1 | bl2.e0 | bl2.e1 | bl3.e0 | bl3.e1 |
+// entries23 = | bl0.e2 | bl0.e3 | bl1.e2 | bl1.e3 | bl2.e2 | bl2.e3 | bl3.e2 | bl3.e3 |
+//
+// entries are in the order of goofySimdSelectorCounts
+template<GoofyCodecType CODEC_TYPE>
+goofy_inline void getBlockPalettes(const uint32_t* goofy_restrict colors, uint8x16x3_t& entries01, uint8x16x3_t& entries23)
+{
+    const uint8x16_t evenLanes = simd::fetch(&gConstLowHalf);
+    const uint8x16_t c = simd::fetch(colors);
+    if (CODEC_TYPE == GOOFY_DXT1)
+    {
+        entries01 = convertRgb565ToRgb888(c);
+
+        // c0 > c1 (unsigned) in both lanes
+        const uint8x16_t signedC = simd::add16(c, simd::fetch(&gConstWordSign));
+        const uint8x16_t c0Greater = simd::cmplt16(simd::swapPairs16(signedC), signedC);
+        const uint8x16_t fourColor = simd::select(evenLanes, c0Greater, simd::swapPairs16(c0Greater));
+
+        const uint8x16_t* channels[3] = {&entries01.r0, &entries01.r1, &entries01.r2};
+        uint8x16_t* results[3] = {&entries23.r0, &entries23.r1, &entries23.r2};
+        for (int ch = 0; ch < 3; ch++)
+        {
+            const uint8x16_t e01 = *channels[ch];
+            const uint8x16_t e10 = simd::swapPairs16(e01);
+            // (2 * c0 + c1) / 3 | (c0 + 2 * c1) / 3, x / 3 = (x * 21846) >> 16 for x <= 765 (rounded down)
+            const uint8x16_t thirds = simd::mulhiu16(simd::add16(simd::add16(e01, e01), e10), simd::fetch(&gConstWordOneThird));
+            // 3-color mode: (c0 + c1) / 2 | black
+            const uint8x16_t half = simd::bit_and(simd::shiftRight16<1>(simd::add16(e01, e10)), evenLanes);
+            *results[ch] = simd::select(fourColor, thirds, half);
+        }
+    }
+    else
+    {
+        // ETC1s base color is rgb555 (delta bits are zero), r | b (bits 3..7 of both halves) and g (bits 11..15 of the lower half)
+        const uint8x16_t rb5 = simd::bit_and(simd::shiftRight16<3>(c), simd::fetch(&gConstWord5Bits));
+        const uint8x16_t g5 = simd::shiftRight16<11>(c);
+        const uint8x16_t rb = simd::bit_or(simd::shiftLeft16<3>(rb5), simd::shiftRight16<2>(rb5));
+        const uint8x16_t g = simd::bit_or(simd::shiftLeft16<3>(g5), simd::shiftRight16<2>(g5));
+        const uint8x16_t br = simd::swapPairs16(rb);
+        const uint8x16_t base[3] = {simd::select(evenLanes, rb, br), simd::select(evenLanes, g, simd::swapPairs16(g)), simd::select(evenLanes, br, rb)};
+
+        // small | large
+        goofy_align16(uint32_t modifiers[4]);
+        for (int i = 0; i < 4; i++)
+        {
+            const uint32_t table = colors[i] >> 29;
+            modifiers[i] = uint32_t(etc1SmallModifier[table]) | ((etc1LargeModifierRGB[table] & 0xFF) << 16);
+        }
+        const uint8x16_t modifier = simd::fetch(modifiers);
+
+        // ETC decoder clamps every channel
+        const uint8x16_t maxValue = simd::fetch(&gConstWordLowByte);
+        const uint8x16_t zero = simd::zero();
+        entries01.r0 = simd::min16(simd::add16(base[0], modifier), maxValue);
+        entries01.r1 = simd::min16(simd::add16(base[1], modifier), maxValue);
+        entries01.r2 = simd::min16(simd::add16(base[2], modifier), maxValue);
+        entries23.r0 = simd::max16(simd::sub16(base[0], modifier), zero);
+        entries23.r1 = simd::max16(simd::sub16(base[1], modifier), zero);
+        entries23.r2 = simd::max16(simd::sub16(base[2], modifier), zero);
+    }
+}
+
+// Per channel min/max of the palette entries used by the pixels of 4 blocks (one rgb888 color per 32-bit lane)
+goofy_inline void getUsedColorsMinMax(const uint8x16x3_t& entries01, const uint8x16x3_t& entries23, const uint8x16_t& counts01, const uint8x16_t& counts23,
+                                      uint8x16_t& minColors, uint8x16_t& maxColors)
+{
+    const uint8x16_t evenLanes = simd::fetch(&gConstLowHalf);
+    const uint8x16_t zero = simd::zero();
+    const uint8x16_t maxValue = simd::fetch(&gConstWordLowByte);
+
+    // unused entries are ignored
+    const uint8x16_t used01 = simd::cmplt16(zero, counts01);
+    const uint8x16_t used23 = simd::cmplt16(zero, counts23);
+
+    const uint8x16_t* e01[3] = {&entries01.r0, &entries01.r1, &entries01.r2};
+    const uint8x16_t* e23[3] = {&entries23.r0, &entries23.r1, &entries23.r2};
+    uint8x16_t minChannels[3];
+    uint8x16_t maxChannels[3];
+    for (int ch = 0; ch < 3; ch++)
+    {
+        const uint8x16_t mn = simd::min16(simd::select(used01, *e01[ch], maxValue), simd::select(used23, *e23[ch], maxValue));
+        const uint8x16_t mx = simd::max16(simd::bit_and(used01, *e01[ch]), simd::bit_and(used23, *e23[ch]));
+        minChannels[ch] = simd::min16(mn, simd::swapPairs16(mn));
+        maxChannels[ch] = simd::max16(mx, simd::swapPairs16(mx));
+    }
+
+    // r | g << 8 (lower lane), b (upper lane)
+    minColors = simd::select(evenLanes, simd::bit_or(minChannels[0], simd::shiftLeft16<8>(minChannels[1])), minChannels[2]);
+    maxColors = simd::select(evenLanes, simd::bit_or(maxChannels[0], simd::shiftLeft16<8>(maxChannels[1])), maxChannels[2]);
+}
+
+template<GoofyCodecType CODEC_TYPE>
+int getStats(const unsigned char* input, unsigned int width, unsigned int height, ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax)
+{
+    // those checks are required because of 4 blocks window
+    if (width % 16 != 0)
+    {
+        return -1;
+    }
+
+    if (height % 4 != 0)
+    {
+        return -2;
+    }
+
+    const unsigned int blocksW = width >> 2;
+    const unsigned int blocksH = height >> 2;
+    const unsigned int tileSize = (tileSizeInBlocks != 0) ? tileSizeInBlocks : 1;
+    const unsigned int tilesW = (blocksW + tileSize - 1) / tileSize;
+    const unsigned int tilesH = (blocksH + tileSize - 1) / tileSize;
+    if (tileMinMax)
+    {
+        for (size_t i = 0; i < size_t(tilesW) * size_t(tilesH); i++)
+        {
+            tileMinMax[i * 2 + 0] = 0xFFFFFF;
+            tileMinMax[i * 2 + 1] = 0;
+        }
+    }
+
+    uint64_t sumR = 0;
+    uint64_t sumG = 0;
+    uint64_t sumB = 0;
+    uint32_t histogram[16] = {0};
+
+    goofy_align16(uint32_t counts[16]);
+    goofy_align16(uint32_t colors[4]);
+    goofy_align16(uint32_t bins[8]);
+    goofy_align16(uint32_t binCounts[8]);
+    goofy_align16(uint32_t minColors[4]);
+    goofy_align16(uint32_t maxColors[4]);
+    for (unsigned int y = 0; y < blocksH; y++)
+    {
+        uint32_t* tileRow = tileMinMax ? tileMinMax + size_t(y / tileSize) * tilesW * 2 : nullptr;
+
+        // per block sums of the row (16 * 255 per block fits 32 bits up to 1M blocks per row)
+        uint8x16_t rowSumR = simd::zero();
+        uint8x16_t rowSumG = simd::zero();
+        uint8x16_t rowSumB = simd::zero();
+        for (unsigned int x = 0; x < blocksW; x += 4)
+        {
+            goofySimdSelectorCounts<CODEC_TYPE>(input, counts, colors);
+            input += 32; // 4 blocks = 8 * 4 = 32
+
+            uint8x16x3_t entries01;
+            uint8x16x3_t entries23;
+            getBlockPalettes<CODEC_TYPE>(colors, entries01, entries23);
+
+            // selector counts in the palette layout
+            const uint8x16_t counts01 = simd::bit_or(simd::fetch(&counts[0]), simd::swapPairs16(simd::fetch(&counts[4])));
+            const uint8x16_t counts23 = simd::bit_or(simd::fetch(&counts[8]), simd::swapPairs16(simd::fetch(&counts[12])));
+
+            // colors weighted by selector counts
+            rowSumR = simd::add32(rowSumR, simd::add32(simd::madd16(entries01.r0, counts01), simd::madd16(entries23.r0, counts23)));
+            rowSumG = simd::add32(rowSumG, simd::add32(simd::madd16(entries01.r1, counts01), simd::madd16(entries23.r1, counts23)));
+            rowSumB = simd::add32(rowSumB, simd::add32(simd::madd16(entries01.r2, counts01), simd::madd16(entries23.r2, counts23)));
+
+            // brightness histogram
+            const uint8x16_t bins01 = simd::shiftRight16<4>(simd::avg16(simd::avg16(entries01.r0, entries01.r2), entries01.r1));
+            const uint8x16_t bins23 = simd::shiftRight16<4>(simd::avg16(simd::avg16(entries23.r0, entries23.r2), entries23.r1));
+            storeLanes(bins01, bins);
+            storeLanes(bins23, bins + 4);
+            storeLanes(counts01, binCounts);
+            storeLanes(counts23, binCounts + 4);
+            for (int i = 0; i < 8; i++)
+            {
+                histogram[bins[i] & 0xFFFF] += binCounts[i] & 0xFFFF;
+                histogram[bins[i] >> 16] += binCounts[i] >> 16;
+            }
+
+            if (tileRow)
+            {
+                uint8x16_t blMinColors;
+                uint8x16_t blMaxColors;
+                getUsedColorsMinMax(entries01, entries23, counts01, counts23, blMinColors, blMaxColors);
+
+                // if the tile size is a multiple of 4, all 4 blocks belong to the same tile
+                unsigned int numTiles = 4;
+                if (tileSize % 4 == 0)
+                {
+                    blMinColors = simd::minu(simd::minu(simd::replicateU0000(blMinColors), simd::replicateU1111(blMinColors)),
+                                             simd::minu(simd::replicateU2222(blMinColors), simd::replicateU3333(blMinColors)));
+                    blMaxColors = simd::maxu(simd::maxu(simd::replicateU0000(blMaxColors), simd::replicateU1111(blMaxColors)),
+                                             simd::maxu(simd::replicateU2222(blMaxColors), simd::replicateU3333(blMaxColors)));
+                    numTiles = 1;
+                }
+
+                storeLanes(blMinColors, minColors);
+                storeLanes(blMaxColors, maxColors);
+                for (unsigned int i = 0; i < numTiles; i++)
+                {
+                    uint32_t* tile = tileRow + ((x + i) / tileSize) * 2;
+                    tile[0] = convertWideToRgb888(minWide(convertRgb888ToWide(tile[0]), convertRgb888ToWide(minColors[i])));
+                    tile[1] = convertWideToRgb888(maxWide(convertRgb888ToWide(tile[1]), convertRgb888ToWide(maxColors[i])));
+                }
+            }
+        }
+
+        goofy_align16(uint32_t rowSums[4]);
+        storeLanes(rowSumR, rowSums);
+        sumR += uint64_t(rowSums[0]) + rowSums[1] + rowSums[2] + rowSums[3];
+        storeLanes(rowSumG, rowSums);
+        sumG += uint64_t(rowSums[0]) + rowSums[1] + rowSums[2] + rowSums[3];
+        storeLanes(rowSumB, rowSums);
+        sumB += uint64_t(rowSums[0]) + rowSums[1] + rowSums[2] + rowSums[3];
+    }
+
+    if (stats)
+    {
+        stats->sumRGB[0] = sumR;
+        stats->sumRGB[1] = sumG;
+        stats->sumRGB[2] = sumB;
+        for (int i = 0; i < 16; i++)
+        {
+            stats->histogram[i] = histogram[i];
+        }
+    }
+    return 0;
+}
+
+int getStatsDXT1(const unsigned char* input, unsigned int width, unsigned int height, ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax)
+{
+    return getStats<GOOFY_DXT1>(input, width, height, stats, tileSizeInBlocks, tileMinMax);
+}
+
+// NOTE: Only ETC1s blocks are supported (the base color and the table codeword of the first sub-block are used)
+int getStatsETC1s(const unsigned char* input, unsigned int width, unsigned int height, ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax)
+{
+    return getStats<GOOFY_ETC1>(input, width, height, stats, tileSizeInBlocks, tileMinMax);
+}
+
 
 
 #undef goofy_restrict
 #undef goofy_inline
 #undef goofy_align16
+#undef GOOFY_PROFILE_BEGIN
+#undef GOOFY_PROFILE_STAGE
+#undef GOOFY_PROFILE_COUNT
 }
 #endif
 
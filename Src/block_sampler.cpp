@@ -0,0 +1,128 @@
+#include "block_sampler.h"
+#include "decoder.h"
+
+static unsigned int roundUpToPowerOfTwoShift(unsigned int v)
+{
+    unsigned int shift = 0;
+    while ((1u << shift) < v && shift < 16)
+    {
+        shift++;
+    }
+    return shift;
+}
+
+BlockSampler::BlockSampler(unsigned int cacheWidthInBlocks, unsigned int cacheHeightInBlocks)
+    : cacheWidthMask((1u << roundUpToPowerOfTwoShift(cacheWidthInBlocks)) - 1)
+    , cacheHeightMask((1u << roundUpToPowerOfTwoShift(cacheHeightInBlocks)) - 1)
+    , cacheWidthShift(roundUpToPowerOfTwoShift(cacheWidthInBlocks))
+    , cache(size_t(cacheWidthMask + 1) * size_t(cacheHeightMask + 1))
+{
+}
+
+void BlockSampler::setTexture(const unsigned char* _data, unsigned int _width, unsigned int _height, Format _format, AddressMode _addressMode)
+{
+    data = _data;
+    width = _width;
+    height = _height;
+    blocksW = _width / 4;
+    format = _format;
+    addressMode = _addressMode;
+    numLookups = 0;
+    numMisses = 0;
+    for (CacheEntry& entry : cache)
+    {
+        entry.tag = 0;
+    }
+}
+
+const uint32_t* BlockSampler::getBlock(unsigned int blockX, unsigned int blockY)
+{
+    // direct-mapped 2D window: neighboring blocks never collide
+    CacheEntry& entry = cache[((blockY & cacheHeightMask) << cacheWidthShift) | (blockX & cacheWidthMask)];
+    const uint32_t tag = blockY * blocksW + blockX + 1;
+    numLookups++;
+    if (entry.tag != tag)
+    {
+        const unsigned char* block = data + size_t(tag - 1) * 8;
+        if (format == FORMAT_DXT1)
+        {
+            DecoderBC::decodeBlockDXT1(block, (unsigned char*)entry.pixels, 16);
+        }
+        else
+        {
+            DecoderBC::decodeBlockETC1(block, (unsigned char*)entry.pixels, 16);
+        }
+        entry.tag = tag;
+        numMisses++;
+    }
+    return entry.pixels;
+}
+
+unsigned int BlockSampler::addressX(int x) const
+{
+    if (addressMode == ADDRESS_WRAP)
+    {
+        const int w = int(width);
+        return (unsigned int)(((x % w) + w) % w);
+    }
+    return (unsigned int)(x < 0 ? 0 : (x >= int(width) ? int(width) - 1 : x));
+}
+
+unsigned int BlockSampler::addressY(int y) const
+{
+    if (addressMode == ADDRESS_WRAP)
+    {
+        const int h = int(height);
+        return (unsigned int)(((y % h) + h) % h);
+    }
+    return (unsigned int)(y < 0 ? 0 : (y >= int(height) ? int(height) - 1 : y));
+}
+
+uint32_t BlockSampler::fetch(int x, int y)
+{
+    const unsigned int tx = addressX(x);
+    const unsigned int ty = addressY(y);
+    return getBlock(tx >> 2, ty >> 2)[(ty & 3) * 4 + (tx & 3)];
+}
+
+void BlockSampler::sample(float u, float v, float rgba[4])
+{
+    const float x = u * float(width) - 0.5f;
+    const float y = v * float(height) - 0.5f;
+    // floor without libm call (no SSE4.1 rounding in SSE2 builds)
+    const int x0 = int(x) - (x < float(int(x)) ? 1 : 0);
+    const int y0 = int(y) - (y < float(int(y)) ? 1 : 0);
+    const float fx = x - float(x0);
+    const float fy = y - float(y0);
+
+    // 2x2 texels, can be in up to 4 different blocks
+    uint32_t t00, t10, t01, t11;
+    const unsigned int tx0 = addressX(x0);
+    const unsigned int ty0 = addressY(y0);
+    if ((tx0 & 3) != 3 && (ty0 & 3) != 3 && x0 >= 0 && y0 >= 0)
+    {
+        // fast path: all texels are in the same block
+        const uint32_t* pixels = getBlock(tx0 >> 2, ty0 >> 2) + (ty0 & 3) * 4 + (tx0 & 3);
+        t00 = pixels[0];
+        t10 = pixels[1];
+        t01 = pixels[4];
+        t11 = pixels[5];
+    }
+    else
+    {
+        t00 = fetch(x0, y0);
+        t10 = fetch(x0 + 1, y0);
+        t01 = fetch(x0, y0 + 1);
+        t11 = fetch(x0 + 1, y0 + 1);
+    }
+
+    const float w00 = (1.0f - fx) * (1.0f - fy);
+    const float w10 = fx * (1.0f - fy);
+    const float w01 = (1.0f - fx) * fy;
+    const float w11 = fx * fy;
+    for (int ch = 0; ch < 4; ch++)
+    {
+        const unsigned int shift = ch * 8;
+        rgba[ch] = float((t00 >> shift) & 0xFF) * w00 + float((t10 >> shift) & 0xFF) * w10 + float((t01 >> shift) & 0xFF) * w01 + float((t11 >> shift) & 0xFF) * w11;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Texture sampler reading DXT1/ETC1 data directly (CPU light map baking, software occlusion)
+//
+// Blocks are decoded on demand with DecoderBC block decoders into a small direct-mapped cache of decoded 4x4 tiles,
+// so the memory usage stays at the compressed size plus the cache. The cache is laid out as a 2D window of blocks,
+// coherent access patterns (neighboring samples) have high hit rates.
+//
+// Not thread safe: use one sampler per thread (samplers can share the same compressed data).
+class BlockSampler
+{
+  public:
+    enum Format
+    {
+        FORMAT_DXT1,
+        FORMAT_ETC1,
+    };
+
+    enum AddressMode
+    {
+        ADDRESS_CLAMP,
+        ADDRESS_WRAP,
+    };
+
+    // cacheWidth x cacheHeight blocks (rounded up to power of two), 16x16 blocks = 17 KB
+    explicit BlockSampler(unsigned int cacheWidthInBlocks = 16, unsigned int cacheHeightInBlocks = 16);
+
+    // Set compressed texture (width and height must be a multiple of 4), the cache is invalidated
+    // data must stay valid while the sampler is used
+    void setTexture(const unsigned char* data, unsigned int width, unsigned int height, Format format, AddressMode addressMode = ADDRESS_CLAMP);
+
+    // Texel at integer coordinates as rgba8 (red in the lowest byte)
+    uint32_t fetch(int x, int y);
+
+    // Bilinear sample at normalized texture coordinates (texel centers are at (i + 0.5) / size), rgba is in 0..255 range
+    void sample(float u, float v, float rgba[4]);
+
+    // Number of block lookups (one per fetch, one or four per bilinear sample) and decoded blocks (cache misses) since setTexture
+    uint64_t getNumLookups() const { return numLookups; }
+    uint64_t getNumMisses() const { return numMisses; }
+
+  private:
+    const uint32_t* getBlock(unsigned int blockX, unsigned int blockY);
+    unsigned int addressX(int x) const;
+    unsigned int addressY(int y) const;
+
+    struct CacheEntry
+    {
+        // block index + 1 (zero = empty)
+        uint32_t tag;
+        uint32_t pixels[16];
+    };
+
+    const unsigned int cacheWidthMask;
+    const unsigned int cacheHeightMask;
+    const unsigned int cacheWidthShift;
+    std::vector<CacheEntry> cache;
+
+    const unsigned char* data = nullptr;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int blocksW = 0;
+    Format format = FORMAT_DXT1;
+    AddressMode addressMode = ADDRESS_CLAMP;
+
+    uint64_t numLookups = 0;
+    uint64_t numMisses = 0;
+};
@@ -1,7 +1,13 @@
 #include "decoder.h"
+#include "parallel_for.h"
 #include <stdint.h>
 #include <string.h> // memset
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define DECODER_SSE2 (1)
+#include <emmintrin.h>
+#endif
+
 // -------------------------------------------------------------------------------------------------------------------
 // This code is borrowed from libktx
 // (C) Ericsson AB 2013. All Rights Reserved.
@@ -926,6 +932,257 @@ void DecompressAlphaDxt5(u8* rgba, void const* block)
 
 
 
+#ifdef DECODER_SSE2
+
+// -------------------------------------------------------------------------------------------------------------------
+// SSE2 decoders (4 blocks at once, bit exact with the libsquish code above)
+// -------------------------------------------------------------------------------------------------------------------
+
+template <int N> static inline __m128i broadcastU32(const __m128i& v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(N, N, N, N)); }
+
+static inline __m128i select(const __m128i& mask, const __m128i& a, const __m128i& b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Four colors palette of 4 blocks (one block per 32-bit lane)
+struct Palette4
+{
+    __m128i c0;
+    __m128i c1;
+    __m128i c2;
+    __m128i c3;
+};
+
+//
+// colors = bl0.c0c1 | bl1.c0c1 | bl2.c0c1 | bl3.c0c1
+//
+template <bool isDxt1> static inline Palette4 decodePaletteX4(const __m128i& colors)
+{
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+
+    // unpack the endpoints (16-bit lanes = bl0.c0 | bl0.c1 | bl1.c0 | bl1.c1 | ...)
+    const __m128i r5 = _mm_srli_epi16(colors, 11);
+    const __m128i g6 = _mm_and_si128(_mm_srli_epi16(colors, 5), mask6);
+    const __m128i b5 = _mm_and_si128(colors, mask5);
+
+    // scale up to 8 bits
+    const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+    const __m128i rg = _mm_or_si128(r8, _mm_slli_epi16(g8, 8));
+    const __m128i ba = _mm_or_si128(b8, _mm_set1_epi16((short)0xFF00));
+
+    // bl0.c0 | bl0.c1 | bl1.c0 | bl1.c1  ->  bl0.c0 | bl1.c0 | bl0.c1 | bl1.c1
+    const __m128i ep01 = _mm_shuffle_epi32(_mm_unpacklo_epi16(rg, ba), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i ep23 = _mm_shuffle_epi32(_mm_unpackhi_epi16(rg, ba), _MM_SHUFFLE(3, 1, 2, 0));
+
+    Palette4 res;
+    res.c0 = _mm_unpacklo_epi64(ep01, ep23);
+    res.c1 = _mm_unpackhi_epi64(ep01, ep23);
+
+    // generate the midpoints using 16-bit math
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c0lo = _mm_unpacklo_epi8(res.c0, zero);
+    const __m128i c0hi = _mm_unpackhi_epi8(res.c0, zero);
+    const __m128i c1lo = _mm_unpacklo_epi8(res.c1, zero);
+    const __m128i c1hi = _mm_unpackhi_epi8(res.c1, zero);
+
+    // x / 3 = (x * 21846) >> 16 (exact for x < 768)
+    const __m128i oneThird = _mm_set1_epi16(21846);
+    const __m128i c2lo = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c0lo, c0lo), c1lo), oneThird);
+    const __m128i c2hi = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c0hi, c0hi), c1hi), oneThird);
+    const __m128i c3lo = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c1lo, c1lo), c0lo), oneThird);
+    const __m128i c3hi = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c1hi, c1hi), c0hi), oneThird);
+    res.c2 = _mm_packus_epi16(c2lo, c2hi);
+    res.c3 = _mm_packus_epi16(c3lo, c3hi);
+
+    if (isDxt1)
+    {
+        // 3-color mode (c0 <= c1): c2 = (c0 + c1) / 2, c3 = transparent black
+        const __m128i c2HalfLo = _mm_srli_epi16(_mm_add_epi16(c0lo, c1lo), 1);
+        const __m128i c2HalfHi = _mm_srli_epi16(_mm_add_epi16(c0hi, c1hi), 1);
+
+        // unsigned 16-bit compare c0 > c1, sign extended to the whole 32-bit lane
+        const __m128i signBit = _mm_set1_epi16((short)0x8000);
+        const __m128i gt = _mm_cmpgt_epi16(_mm_xor_si128(colors, signBit), _mm_xor_si128(_mm_srli_epi32(colors, 16), signBit));
+        const __m128i fourColorMask = _mm_srai_epi32(_mm_slli_epi32(gt, 16), 16);
+
+        res.c2 = select(fourColorMask, res.c2, _mm_packus_epi16(c2HalfLo, c2HalfHi));
+        res.c3 = _mm_and_si128(fourColorMask, res.c3);
+    }
+
+    return res;
+}
+
+// Write out 4x4 pixels of the block (N = block index inside Palette4)
+// alpha = optional per-pixel alpha (16 bytes) to override palette alpha
+template <int N> static inline void storeBlockColors(const Palette4& palette, const __m128i& indices, const unsigned char* alpha, unsigned char* target, size_t targetStride)
+{
+    const __m128i c0 = broadcastU32<N>(palette.c0);
+    const __m128i c1 = broadcastU32<N>(palette.c1);
+    const __m128i c2 = broadcastU32<N>(palette.c2);
+    const __m128i c3 = broadcastU32<N>(palette.c3);
+
+    // index bits of the row pixels
+    const __m128i loBits = _mm_setr_epi32(0x01, 0x04, 0x10, 0x40);
+    const __m128i hiBits = _mm_setr_epi32(0x02, 0x08, 0x20, 0x80);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i blIndices = broadcastU32<N>(indices);
+    for (int row = 0; row < 4; row++)
+    {
+        const __m128i loMask = _mm_cmpeq_epi32(_mm_and_si128(blIndices, loBits), loBits);
+        const __m128i hiMask = _mm_cmpeq_epi32(_mm_and_si128(blIndices, hiBits), hiBits);
+        __m128i rowColors = select(hiMask, select(loMask, c3, c2), select(loMask, c1, c0));
+        if (alpha)
+        {
+            int rowAlpha;
+            memcpy(&rowAlpha, alpha + row * 4, 4);
+            // a0 | a1 | a2 | a3  ->  000a0 | 000a1 | 000a2 | 000a3
+            const __m128i alpha32 = _mm_unpacklo_epi16(zero, _mm_unpacklo_epi8(zero, _mm_cvtsi32_si128(rowAlpha)));
+            rowColors = _mm_or_si128(_mm_andnot_si128(_mm_set1_epi32((int)0xFF000000), rowColors), alpha32);
+        }
+        _mm_storeu_si128((__m128i*)(target + targetStride * row), rowColors);
+        blIndices = _mm_srli_epi32(blIndices, 8);
+    }
+}
+
+// DXT5 alpha block to 16 alpha values
+static inline void decodeAlphaDxt5(const unsigned char* source, unsigned char* alpha)
+{
+    const int alpha0 = source[0];
+    const int alpha1 = source[1];
+
+    // codebook = (w0 * alpha0 + w1 * alpha1) / divider
+    __m128i codes16;
+    if (alpha0 <= alpha1)
+    {
+        // 5-alpha codebook, x / 5 = (x * 13108) >> 16 (exact for x < 1280)
+        const __m128i w0 = _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0);
+        const __m128i w1 = _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0);
+        const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_set1_epi16((short)alpha0), w0), _mm_mullo_epi16(_mm_set1_epi16((short)alpha1), w1));
+        codes16 = _mm_or_si128(_mm_mulhi_epu16(sum, _mm_set1_epi16(13108)), _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+    }
+    else
+    {
+        // 7-alpha codebook, x / 7 = (x * 9363) >> 16 (exact for x < 1792)
+        const __m128i w0 = _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1);
+        const __m128i w1 = _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6);
+        const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_set1_epi16((short)alpha0), w0), _mm_mullo_epi16(_mm_set1_epi16((short)alpha1), w1));
+        codes16 = _mm_mulhi_epu16(sum, _mm_set1_epi16(9363));
+    }
+
+    unsigned char codes[16];
+    _mm_storeu_si128((__m128i*)&codes[0], _mm_packus_epi16(codes16, codes16));
+
+    // 16 x 3-bit indices
+    uint64_t indices = 0;
+    memcpy(&indices, source + 2, 6);
+    for (int i = 0; i < 16; i++)
+    {
+        alpha[i] = codes[(indices >> (3 * i)) & 0x7];
+    }
+}
+
+// ETC1 intensity modifiers (small / large) replicated to RGB
+static const uint32_t etcModifierSmall[8] = { 0x00020202, 0x00050505, 0x00090909, 0x000D0D0D, 0x00121212, 0x00181818, 0x00212121, 0x002F2F2F };
+static const uint32_t etcModifierLarge[8] = { 0x00080808, 0x00111111, 0x001D1D1D, 0x002A2A2A, 0x003C3C3C, 0x00505050, 0x006A6A6A, 0x00B7B7B7 };
+
+//
+// Write out 4x4 pixels of the ETC1 block
+//
+// indices = pixel indices (bytes 4..7 of the block as little-endian uint32)
+// subBlockMask[row] = per pixel mask (0xFFFFFFFF = first sub-block)
+//
+static inline void storeBlockETC(const __m128i& base0, const __m128i& base1, const __m128i& small0, const __m128i& small1,
+                                 const __m128i& large0, const __m128i& large1, const __m128i* subBlockMask, uint32_t indices,
+                                 unsigned char* target, size_t targetStride)
+{
+    // Pixel p = x * 4 + y
+    //   MSB (negative modifier) bit = p ^ 8
+    //   LSB (large modifier) bit = 16 + (p ^ 8)
+    const __m128i negBits = _mm_setr_epi32(0x00000100, 0x00001000, 0x00000001, 0x00000010);
+    const __m128i largeBits = _mm_setr_epi32(0x01000000, 0x10000000, 0x00010000, 0x00100000);
+
+    __m128i blIndices = _mm_set1_epi32((int)indices);
+    for (int row = 0; row < 4; row++)
+    {
+        const __m128i negMask = _mm_cmpeq_epi32(_mm_and_si128(blIndices, negBits), negBits);
+        const __m128i largeMask = _mm_cmpeq_epi32(_mm_and_si128(blIndices, largeBits), largeBits);
+
+        const __m128i base = select(subBlockMask[row], base0, base1);
+        const __m128i modifier = select(largeMask, select(subBlockMask[row], large0, large1), select(subBlockMask[row], small0, small1));
+
+        // saturated add/sub is the same as CLAMP(0, base +/- modifier, 255)
+        const __m128i rowColors = select(negMask, _mm_subs_epu8(base, modifier), _mm_adds_epu8(base, modifier));
+        _mm_storeu_si128((__m128i*)(target + targetStride * row), rowColors);
+        blIndices = _mm_srli_epi32(blIndices, 1);
+    }
+}
+
+// Decode ETC1 block (individual/differential modes)
+// returns false for ETC2 T/H/planar blocks
+static inline bool decodeBlockETC1Simd(const unsigned char* source, unsigned char* target, size_t targetStride)
+{
+    const uint32_t control = source[3];
+    const uint32_t flip = control & 1;
+
+    uint32_t base0;
+    uint32_t base1;
+    if (control & 2)
+    {
+        // differential mode: 5-bit base color + 3-bit signed delta
+        const int r = source[0] >> 3;
+        const int g = source[1] >> 3;
+        const int b = source[2] >> 3;
+        const int r2 = r + ((int)((uint32_t)source[0] << 29) >> 29);
+        const int g2 = g + ((int)((uint32_t)source[1] << 29) >> 29);
+        const int b2 = b + ((int)((uint32_t)source[2] << 29) >> 29);
+        if (r2 < 0 || r2 > 31 || g2 < 0 || g2 > 31 || b2 < 0 || b2 > 31)
+        {
+            return false;
+        }
+
+        base0 = (uint32_t)(((r << 3) | (r >> 2)) | (((g << 3) | (g >> 2)) << 8) | (((b << 3) | (b >> 2)) << 16));
+        base1 = (uint32_t)(((r2 << 3) | (r2 >> 2)) | (((g2 << 3) | (g2 >> 2)) << 8) | (((b2 << 3) | (b2 >> 2)) << 16));
+    }
+    else
+    {
+        // individual mode: two 4-bit base colors
+        uint32_t rgb = 0;
+        memcpy(&rgb, source, 3);
+        base0 = ((rgb >> 4) & 0x0F0F0F) * 0x11;
+        base1 = (rgb & 0x0F0F0F) * 0x11;
+    }
+
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i leftHalf = _mm_setr_epi32(-1, -1, 0, 0);
+
+    // flip = 0: 2x4 left/right sub-blocks, flip = 1: 4x2 top/bottom sub-blocks
+    const __m128i subBlockMask[2][4] = {
+        { leftHalf, leftHalf, leftHalf, leftHalf },
+        { ones, ones, zero, zero },
+    };
+
+    uint32_t indices;
+    memcpy(&indices, source + 4, 4);
+
+    const uint32_t cw0 = control >> 5;
+    const uint32_t cw1 = (control >> 2) & 7;
+    storeBlockETC(_mm_or_si128(_mm_set1_epi32((int)base0), alpha), _mm_or_si128(_mm_set1_epi32((int)base1), alpha),
+                  _mm_set1_epi32((int)etcModifierSmall[cw0]), _mm_set1_epi32((int)etcModifierSmall[cw1]),
+                  _mm_set1_epi32((int)etcModifierLarge[cw0]), _mm_set1_epi32((int)etcModifierLarge[cw1]),
+                  &subBlockMask[flip][0], indices, target, targetStride);
+    return true;
+}
+
+#endif // DECODER_SSE2
+
 namespace DecoderBC
 {
 
@@ -957,6 +1214,13 @@ void decodeBlockDXT5(const unsigned char* source, unsigned char* target, size_t
 
 void decodeBlockETC1(const unsigned char* source, unsigned char* target, size_t targetStide)
 {
+#ifdef DECODER_SSE2
+    if (decodeBlockETC1Simd(source, target, targetStide))
+    {
+        return;
+    }
+#endif
+
     unsigned char rgba8[64];
     memset(&rgba8[0], 0xFF, 64);
 
@@ -972,6 +1236,14 @@ void decodeBlockETC1(const unsigned char* source, unsigned char* target, size_t
 
 void decodeBlockETC2(const unsigned char* source, unsigned char* target, size_t targetStide)
 {
+#ifdef DECODER_SSE2
+    if (decodeBlockETC1Simd(source + 8, target, targetStide))
+    {
+        decompressBlockAlphaC(source, target + 3, (int)(targetStide / 4), 4, 0, 0, 4);
+        return;
+    }
+#endif
+
     unsigned char rgba8[64];
     memset(&rgba8[0], 0xFF, 64);
 
@@ -987,4 +1259,172 @@ void decodeBlockETC2(const unsigned char* source, unsigned char* target, size_t
     memcpy(target + targetStide * 3, &rgba8[48], 16);
 }
 
+void decodeBlocksDXT1x4(const unsigned char* source, unsigned char* target, size_t targetStide)
+{
+#ifdef DECODER_SSE2
+    // bl0.c0c1 | bl0.indices | bl1.c0c1 | bl1.indices  ->  bl0.c0c1 | bl1.c0c1 | bl0.indices | bl1.indices
+    const __m128i bl01 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)source), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i bl23 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(source + 16)), _MM_SHUFFLE(3, 1, 2, 0));
+
+    const __m128i colors = _mm_unpacklo_epi64(bl01, bl23);
+    const __m128i indices = _mm_unpackhi_epi64(bl01, bl23);
+
+    const Palette4 palette = decodePaletteX4<true>(colors);
+    storeBlockColors<0>(palette, indices, nullptr, target, targetStide);
+    storeBlockColors<1>(palette, indices, nullptr, target + 16, targetStide);
+    storeBlockColors<2>(palette, indices, nullptr, target + 32, targetStide);
+    storeBlockColors<3>(palette, indices, nullptr, target + 48, targetStide);
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        decodeBlockDXT1(source + i * 8, target + i * 16, targetStide);
+    }
+#endif
+}
+
+void decodeBlocksDXT5x4(const unsigned char* source, unsigned char* target, size_t targetStide)
+{
+#ifdef DECODER_SSE2
+    // bl0.alpha | bl0.c0c1 | bl0.indices  ->  bl0.c0c1 | bl1.c0c1 | bl0.indices | bl1.indices
+    const __m128i bl01 = _mm_unpackhi_epi32(_mm_loadu_si128((const __m128i*)source), _mm_loadu_si128((const __m128i*)(source + 16)));
+    const __m128i bl23 = _mm_unpackhi_epi32(_mm_loadu_si128((const __m128i*)(source + 32)), _mm_loadu_si128((const __m128i*)(source + 48)));
+
+    const __m128i colors = _mm_unpacklo_epi64(bl01, bl23);
+    const __m128i indices = _mm_unpackhi_epi64(bl01, bl23);
+
+    const Palette4 palette = decodePaletteX4<false>(colors);
+
+    unsigned char alpha[4][16];
+    decodeAlphaDxt5(source, alpha[0]);
+    decodeAlphaDxt5(source + 16, alpha[1]);
+    decodeAlphaDxt5(source + 32, alpha[2]);
+    decodeAlphaDxt5(source + 48, alpha[3]);
+
+    storeBlockColors<0>(palette, indices, alpha[0], target, targetStide);
+    storeBlockColors<1>(palette, indices, alpha[1], target + 16, targetStide);
+    storeBlockColors<2>(palette, indices, alpha[2], target + 32, targetStide);
+    storeBlockColors<3>(palette, indices, alpha[3], target + 48, targetStide);
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        decodeBlockDXT5(source + i * 16, target + i * 16, targetStide);
+    }
+#endif
+}
+
+void decodeBlocksETC1x4(const unsigned char* source, unsigned char* target, size_t targetStide)
+{
+#ifdef DECODER_SSE2
+    // bl0.rgbc | bl0.indices | bl1.rgbc | bl1.indices  ->  bl0.rgbc | bl1.rgbc | bl0.indices | bl1.indices
+    const __m128i bl01 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)source), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i bl23 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(source + 16)), _MM_SHUFFLE(3, 1, 2, 0));
+
+    const __m128i rgbc = _mm_unpacklo_epi64(bl01, bl23);
+    const __m128i indices = _mm_unpackhi_epi64(bl01, bl23);
+
+    // ETC1s = differential mode, zero delta and the same table for both sub-blocks
+    const __m128i notEtc1s = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(rgbc, _mm_set1_epi32(0x00070707)), _mm_andnot_si128(rgbc, _mm_set1_epi32(0x02000000))),
+        _mm_and_si128(_mm_xor_si128(_mm_slli_epi32(rgbc, 3), rgbc), _mm_set1_epi32((int)0xE0000000)));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(notEtc1s, _mm_setzero_si128())) != 0xFFFF)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            decodeBlockETC1(source + i * 8, target + i * 16, targetStide);
+        }
+        return;
+    }
+
+    // Fast path (four ETC1s blocks)
+    // base = c | (c >> 5)
+    const __m128i base555 = _mm_and_si128(rgbc, _mm_set1_epi32(0x00F8F8F8));
+    const __m128i base = _mm_or_si128(_mm_or_si128(base555, _mm_and_si128(_mm_srli_epi16(base555, 5), _mm_set1_epi8(0x07))), _mm_set1_epi32((int)0xFF000000));
+
+    uint32_t blRgbc[4];
+    uint32_t blIndices[4];
+    _mm_storeu_si128((__m128i*)&blRgbc[0], rgbc);
+    _mm_storeu_si128((__m128i*)&blIndices[0], indices);
+
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i subBlockMask[4] = { ones, ones, ones, ones };
+
+    const __m128i base0 = broadcastU32<0>(base);
+    const __m128i small0 = _mm_set1_epi32((int)etcModifierSmall[blRgbc[0] >> 29]);
+    const __m128i large0 = _mm_set1_epi32((int)etcModifierLarge[blRgbc[0] >> 29]);
+    storeBlockETC(base0, base0, small0, small0, large0, large0, subBlockMask, blIndices[0], target, targetStide);
+
+    const __m128i base1 = broadcastU32<1>(base);
+    const __m128i small1 = _mm_set1_epi32((int)etcModifierSmall[blRgbc[1] >> 29]);
+    const __m128i large1 = _mm_set1_epi32((int)etcModifierLarge[blRgbc[1] >> 29]);
+    storeBlockETC(base1, base1, small1, small1, large1, large1, subBlockMask, blIndices[1], target + 16, targetStide);
+
+    const __m128i base2 = broadcastU32<2>(base);
+    const __m128i small2 = _mm_set1_epi32((int)etcModifierSmall[blRgbc[2] >> 29]);
+    const __m128i large2 = _mm_set1_epi32((int)etcModifierLarge[blRgbc[2] >> 29]);
+    storeBlockETC(base2, base2, small2, small2, large2, large2, subBlockMask, blIndices[2], target + 32, targetStide);
+
+    const __m128i base3 = broadcastU32<3>(base);
+    const __m128i small3 = _mm_set1_epi32((int)etcModifierSmall[blRgbc[3] >> 29]);
+    const __m128i large3 = _mm_set1_epi32((int)etcModifierLarge[blRgbc[3] >> 29]);
+    storeBlockETC(base3, base3, small3, small3, large3, large3, subBlockMask, blIndices[3], target + 48, targetStide);
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        decodeBlockETC1(source + i * 8, target + i * 16, targetStide);
+    }
+#endif
+}
+
+typedef void (*DecodeBlockFunc_t)(const unsigned char* source, unsigned char* target, size_t targetStide);
+
+template <size_t BLOCK_SIZE>
+static void decompressImage(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride,
+                            unsigned int numThreads, DecodeBlockFunc_t decodeBlock, DecodeBlockFunc_t decodeBlocksX4)
+{
+    const size_t blockW = width / 4;
+    const size_t blockH = height / 4;
+    parallelFor(blockH, numThreads, [&](size_t beginRow, size_t endRow) {
+        for (size_t by = beginRow; by < endRow; by++)
+        {
+            const unsigned char* source = data + by * blockW * BLOCK_SIZE;
+            unsigned char* target = rgba8 + by * 4 * rgba8Stride;
+
+            size_t bx = 0;
+            if (decodeBlocksX4)
+            {
+                for (; bx + 4 <= blockW; bx += 4)
+                {
+                    decodeBlocksX4(source + bx * BLOCK_SIZE, target + bx * 16, rgba8Stride);
+                }
+            }
+
+            for (; bx < blockW; bx++)
+            {
+                decodeBlock(source + bx * BLOCK_SIZE, target + bx * 16, rgba8Stride);
+            }
+        }
+    });
+}
+
+void decompressDXT1(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads)
+{
+    decompressImage<8>(data, width, height, rgba8, rgba8Stride, numThreads, decodeBlockDXT1, decodeBlocksDXT1x4);
+}
+
+void decompressDXT5(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads)
+{
+    decompressImage<16>(data, width, height, rgba8, rgba8Stride, numThreads, decodeBlockDXT5, decodeBlocksDXT5x4);
+}
+
+void decompressETC1(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads)
+{
+    decompressImage<8>(data, width, height, rgba8, rgba8Stride, numThreads, decodeBlockETC1, decodeBlocksETC1x4);
+}
+
+void decompressETC2(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads)
+{
+    decompressImage<16>(data, width, height, rgba8, rgba8Stride, numThreads, decodeBlockETC2, nullptr);
+}
+
 }
\ No newline at end of file
@@ -6,4 +6,16 @@ void decodeBlockDXT1(const unsigned char* source, unsigned char* target, size_t
 void decodeBlockDXT5(const unsigned char* source, unsigned char* target, size_t targetStide);
 void decodeBlockETC1(const unsigned char* source, unsigned char* target, size_t targetStide);
 void decodeBlockETC2(const unsigned char* source, unsigned char* target, size_t targetStide);
+
+// Decode 4 consecutive blocks (16x4 pixels) at once
+void decodeBlocksDXT1x4(const unsigned char* source, unsigned char* target, size_t targetStide);
+void decodeBlocksDXT5x4(const unsigned char* source, unsigned char* target, size_t targetStide);
+void decodeBlocksETC1x4(const unsigned char* source, unsigned char* target, size_t targetStide);
+
+// Decode the whole image, rows of blocks are decoded in parallel (numThreads = 0 means use all hardware threads)
+// width and height must be a multiple of 4, rgba8Stride = distance between rows of the output image in bytes
+void decompressDXT1(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads = 0);
+void decompressDXT5(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads = 0);
+void decompressETC1(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads = 0);
+void decompressETC2(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads = 0);
 } // namespace DecoderBC
@@ -1,8 +1,12 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #ifdef __EMSCRIPTEN__
@@ -11,12 +15,22 @@
 #endif
 
 #ifndef _WIN32
+#include <unistd.h>
 #define __cdecl
 #define __stdcall
 #define __fastcall
 //and others
 #endif
 
+#ifdef BENCHMARK_PIN_THREAD
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+#endif
+
 #define GOOFYTC_IMPLEMENTATION
 #include "../GoofyTC/goofy_tc.h"
 
@@ -38,25 +52,122 @@
 #include "../ThirdParty/lodepng/lodepng.h"
 #include "../ThirdParty/lodepng/lodepng.cpp"
 
+#include "block_sampler.h"
 #include "decoder.h"
+#include "parallel_for.h"
+#include "perf_counters.h"
+#include "progressive_encoder.h"
+#include "ssim.h"
 
 const int kNumberOfIterations = 128;
 
+#ifdef ENABLE_ROBUST_BENCHMARK
+// untimed runs before the measurement (caches, branch predictors, CPU clocks)
+const int kNumberOfWarmupIterations = 16;
+#else
+const int kNumberOfWarmupIterations = 0;
+#endif
+
 struct Timer
 {
-    std::chrono::time_point<std::chrono::high_resolution_clock> startingTime;
+    std::chrono::time_point<std::chrono::steady_clock> startingTime;
 
     Timer() {}
 
-    void begin() { startingTime = std::chrono::high_resolution_clock::now(); }
+    void begin() { startingTime = std::chrono::steady_clock::now(); }
 
     // return number of microseconds
     uint64_t end()
     {
-        const auto endingTime = std::chrono::high_resolution_clock::now();
+        const auto endingTime = std::chrono::steady_clock::now();
         return std::chrono::duration_cast<std::chrono::microseconds>(endingTime - startingTime).count();
     }
+
+    // return number of nanoseconds
+    uint64_t endNs()
+    {
+        const auto endingTime = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(endingTime - startingTime).count();
+    }
+};
+
+// Timing distribution of a benchmark (all values are in nanoseconds)
+struct BenchmarkStats
+{
+    unsigned int numberOfSamples = 0;
+    double minNs = 0.0;
+    double medianNs = 0.0;
+    double p90Ns = 0.0;
+    double p99Ns = 0.0;
+    // median absolute deviation
+    double madNs = 0.0;
+};
+
+// linear interpolation between closest ranks, samples must be sorted
+static double getPercentile(const std::vector<double>& sortedSamples, double percentile)
+{
+    const double pos = percentile * double(sortedSamples.size() - 1);
+    const size_t index = size_t(pos);
+    if (index + 1 >= sortedSamples.size())
+    {
+        return sortedSamples.back();
+    }
+    const double t = pos - double(index);
+    return sortedSamples[index] * (1.0 - t) + sortedSamples[index + 1] * t;
+}
+
+#ifdef ENABLE_PERF_COUNTERS
+// Hardware counters of a benchmark, per 4x4 block (sum over all timed runs), negative values = counter is not available
+struct PerfCounterStats
+{
+    bool isAvailable = false;
+    double ipc = -1.0;
+    double cyclesPerBlock = -1.0;
+    double l1dMissesPerBlock = -1.0;
+    double llcMissesPerBlock = -1.0;
+    double branchMissesPerBlock = -1.0;
 };
+#endif
+
+BenchmarkStats computeBenchmarkStats(std::vector<double>& samplesNs)
+{
+    BenchmarkStats stats;
+    if (samplesNs.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samplesNs.begin(), samplesNs.end());
+    stats.numberOfSamples = (unsigned int)samplesNs.size();
+    stats.minNs = samplesNs.front();
+    stats.medianNs = getPercentile(samplesNs, 0.5);
+    stats.p90Ns = getPercentile(samplesNs, 0.9);
+    stats.p99Ns = getPercentile(samplesNs, 0.99);
+
+    std::vector<double> deviations(samplesNs.size());
+    for (size_t i = 0; i < samplesNs.size(); i++)
+    {
+        deviations[i] = std::abs(samplesNs[i] - stats.medianNs);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    stats.madNs = getPercentile(deviations, 0.5);
+    return stats;
+}
+
+// Pin the calling thread to the first core (less scheduler noise in benchmarks)
+bool pinCurrentThread()
+{
+#if defined(BENCHMARK_PIN_THREAD) && defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), 1) != 0;
+#elif defined(BENCHMARK_PIN_THREAD) && defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(0, &cpuSet);
+    return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
 
 // KTX / DDS / TGA support
 // ============================================================================================
@@ -395,60 +506,138 @@ double getPSNR(double mse, const double pixelMaxValue = 255.0)
     return psnr;
 }
 
-static double getLuminosity(double r, double g, double b)
-{
-    return 0.21 * r + 0.72 * g + 0.07 * b;
-}
+// Luminosity = 0.21 * R + 0.72 * G + 0.07 * B
+//
+// dY^2 = (0.21 * dR + 0.72 * dG + 0.07 * dB)^2 can be computed from the sums of squared and cross channel differences
+static const double kLumR = 0.21;
+static const double kLumG = 0.72;
+static const double kLumB = 0.07;
 
-static MsePsnr getMsePsnr(const unsigned char* buf1, const unsigned char* buf2, uint32_t width, uint32_t height)
+// Sum of squared differences (R = bits 16..23, G = bits 8..15, B = bits 0..7, A = bits 24..31)
+struct SsdSums
 {
-    const uint32_t* img1 = (const uint32_t*)buf1;
-    const uint32_t* img2 = (const uint32_t*)buf2;
+    int64_t rr = 0;
+    int64_t gg = 0;
+    int64_t bb = 0;
+    int64_t aa = 0;
 
-    MsePsnr res;
-    res.mseR = 0.0;
-    res.mseG = 0.0;
-    res.mseB = 0.0;
-    res.mseA = 0.0;
-    res.mseRGB = 0.0;
-    res.mseY = 0.0;
-    for (uint32_t y = 0; y < height; y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-        {
-            uint32_t addr = y * width + x;
-            const uint32_t& pix1 = img1[addr];
-            const uint32_t& pix2 = img2[addr];
-            
-            double r1 = (double)((pix1 >> 16) & 0xFF);
-            double g1 = (double)((pix1 >> 8) & 0xFF);
-            double b1 = (double)(pix1 & 0xFF);
-            double a1 = (double)((pix1 >> 24) & 0xFF);
+    // cross channel terms (for luminosity)
+    int64_t rg = 0;
+    int64_t rb = 0;
+    int64_t gb = 0;
 
-            double r2 = (double)((pix2 >> 16) & 0xFF);
-            double g2 = (double)((pix2 >> 8) & 0xFF);
-            double b2 = (double)(pix2 & 0xFF);
-            double a2 = (double)((pix2 >> 24) & 0xFF);
+    void add(const SsdSums& other)
+    {
+        rr += other.rr;
+        gg += other.gg;
+        bb += other.bb;
+        aa += other.aa;
+        rg += other.rg;
+        rb += other.rb;
+        gb += other.gb;
+    }
+};
 
-            double y1 = getLuminosity(r1, g1, b1);
-            double y2 = getLuminosity(r2, g2, b2);
+static void accumulatePixelSsd(SsdSums& sums, uint32_t pix1, uint32_t pix2)
+{
+    int dR = (int)((pix1 >> 16) & 0xFF) - (int)((pix2 >> 16) & 0xFF);
+    int dG = (int)((pix1 >> 8) & 0xFF) - (int)((pix2 >> 8) & 0xFF);
+    int dB = (int)(pix1 & 0xFF) - (int)(pix2 & 0xFF);
+    int dA = (int)((pix1 >> 24) & 0xFF) - (int)((pix2 >> 24) & 0xFF);
+    sums.rr += dR * dR;
+    sums.gg += dG * dG;
+    sums.bb += dB * dB;
+    sums.aa += dA * dA;
+    sums.rg += dR * dG;
+    sums.rb += dR * dB;
+    sums.gb += dG * dB;
+}
 
-            double dY = (y2 - y1);
-            res.mseY += (dY * dY);
+static void accumulateRowSsd(SsdSums& sums, const uint32_t* row1, const uint32_t* row2, uint32_t width)
+{
+    uint32_t x = 0;
+#ifdef GOOFY_SSE2
+    // 32-bit accumulators are flushed to 64-bit every kMaxPixelsPerFlush pixels
+    // (worst case per lane = 255 * 255 * kMaxPixelsPerFlush < 2^31)
+    const uint32_t kMaxPixelsPerFlush = 32768;
+    const __m128i zero = _mm_setzero_si128();
+    const uint32_t width4 = width & ~3u;
+    while (x < width4)
+    {
+        __m128i accSquares = _mm_setzero_si128();
+        __m128i accCross = _mm_setzero_si128();
+        const uint32_t chunkEnd = std::min(width4, x + kMaxPixelsPerFlush);
+        for (; x < chunkEnd; x += 4)
+        {
+            const __m128i p1 = _mm_loadu_si128((const __m128i*)(row1 + x));
+            const __m128i p2 = _mm_loadu_si128((const __m128i*)(row2 + x));
+
+            // per channel differences (int16)
+            // b0 g0 r0 a0 b1 g1 r1 a1
+            // b2 g2 r2 a2 b3 g3 r3 a3
+            const __m128i d01 = _mm_sub_epi16(_mm_unpacklo_epi8(p1, zero), _mm_unpacklo_epi8(p2, zero));
+            const __m128i d23 = _mm_sub_epi16(_mm_unpackhi_epi8(p1, zero), _mm_unpackhi_epi8(p2, zero));
+
+            // group the same channels of two pixels
+            // b0 b1 g0 g1 r0 r1 a0 a1
+            // b2 b3 g2 g3 r2 r3 a2 a3
+            const __m128i dPair01 = _mm_unpacklo_epi16(d01, _mm_unpackhi_epi64(d01, d01));
+            const __m128i dPair23 = _mm_unpacklo_epi16(d23, _mm_unpackhi_epi64(d23, d23));
+
+            // b * b | g * g | r * r | a * a
+            accSquares = _mm_add_epi32(accSquares, _mm_madd_epi16(dPair01, dPair01));
+            accSquares = _mm_add_epi32(accSquares, _mm_madd_epi16(dPair23, dPair23));
+
+            // b * g | g * r | r * b | a * a
+            accCross = _mm_add_epi32(accCross, _mm_madd_epi16(dPair01, _mm_shuffle_epi32(dPair01, _MM_SHUFFLE(3, 0, 2, 1))));
+            accCross = _mm_add_epi32(accCross, _mm_madd_epi16(dPair23, _mm_shuffle_epi32(dPair23, _MM_SHUFFLE(3, 0, 2, 1))));
+        }
 
-            double dR = r1 - r2;
-            double dG = g1 - g2;
-            double dB = b1 - b2;
-            double dA = a1 - a2;
+        int32_t squares[4];
+        int32_t cross[4];
+        _mm_storeu_si128((__m128i*)&squares[0], accSquares);
+        _mm_storeu_si128((__m128i*)&cross[0], accCross);
+        sums.bb += squares[0];
+        sums.gg += squares[1];
+        sums.rr += squares[2];
+        sums.aa += squares[3];
+        sums.gb += cross[0];
+        sums.rg += cross[1];
+        sums.rb += cross[2];
+    }
+#endif
+    for (; x < width; x++)
+    {
+        accumulatePixelSsd(sums, row1[x], row2[x]);
+    }
+}
 
-            res.mseRGB += (dR * dR) + (dG * dG) + (dB * dB);
+static MsePsnr getMsePsnr(const unsigned char* buf1, const unsigned char* buf2, uint32_t width, uint32_t height)
+{
+    const uint32_t* img1 = (const uint32_t*)buf1;
+    const uint32_t* img2 = (const uint32_t*)buf2;
 
-            res.mseR += (dR * dR);
-            res.mseG += (dG * dG);
-            res.mseB += (dB * dB);
-            res.mseA += (dA * dA);
+    // parallel reduction over rows
+    SsdSums sums;
+    std::mutex sumsMutex;
+    parallelFor(height, 0, [&](size_t beginRow, size_t endRow) {
+        SsdSums localSums;
+        for (size_t y = beginRow; y < endRow; y++)
+        {
+            accumulateRowSsd(localSums, img1 + y * width, img2 + y * width, width);
         }
-    }
+        std::lock_guard<std::mutex> lock(sumsMutex);
+        sums.add(localSums);
+    });
+
+    MsePsnr res;
+    res.mseR = (double)sums.rr;
+    res.mseG = (double)sums.gg;
+    res.mseB = (double)sums.bb;
+    res.mseA = (double)sums.aa;
+    res.mseRGB = (double)(sums.rr + sums.gg + sums.bb);
+    res.mseY = (kLumR * kLumR) * (double)sums.rr + (kLumG * kLumG) * (double)sums.gg + (kLumB * kLumB) * (double)sums.bb +
+               (2.0 * kLumR * kLumG) * (double)sums.rg + (2.0 * kLumR * kLumB) * (double)sums.rb + (2.0 * kLumG * kLumB) * (double)sums.gb;
 
     double pixelsCount = width * height;
     res.mseR = res.mseR / pixelsCount;
@@ -558,113 +747,306 @@ void generateDownsamlpedRgb565Test(const unsigned char* inRgba8, uint32_t width,
 
 // ============================================================================================
 
-void decompressDXT1(const unsigned char* data, uint32_t width, uint32_t height, unsigned char* rgba8)
+// per-block (libsquish) decoder, used as a reference for the decoder benchmark
+void decompressDXT1Reference(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int /*numThreads*/)
 {
-    memset(rgba8, 0, width * height * 4);
-    uint32_t blockW = width / 4;
-    uint32_t blockH = height / 4;
-    uint32_t stride = width * 4;
-    for (uint32_t by = 0; by < blockH; by++)
+    unsigned int blockW = width / 4;
+    unsigned int blockH = height / 4;
+    for (unsigned int by = 0; by < blockH; by++)
     {
-        for (uint32_t bx = 0; bx < blockW; bx++)
+        for (unsigned int bx = 0; bx < blockW; bx++)
         {
-            uint32_t x = bx * 4;
-            uint32_t y = by * 4;
-            DecoderBC::decodeBlockDXT1(data, rgba8 + (y * width + x) * 4, stride);
-            data+=8;
+            DecoderBC::decodeBlockDXT1(data, rgba8 + by * 4 * rgba8Stride + bx * 16, rgba8Stride);
+            data += 8;
         }
     }
 }
 
-void decompressDXT5(const unsigned char* data, uint32_t width, uint32_t height, unsigned char* rgba8)
+// ============================================================================================
+
+struct TestResult
+{
+    std::string encoderName;
+    std::string format;
+    double numberOfPixels;
+    double timeInMicroSeconds;
+    MsePsnr msePsnr;
+    Ssim::SsimResult ssim;
+    // encoders only (runTestDXT1/runTestETC1)
+    BenchmarkStats timing;
+#ifdef ENABLE_PERF_COUNTERS
+    PerfCounterStats perf;
+#endif
+};
+
+typedef int (__cdecl* CompressFunc_t)(unsigned char *dst, const unsigned char *src, unsigned int width, unsigned int height, unsigned int stride);
+
+#ifdef GOOFY_PROFILE
+// Print Goofy encoder stage costs (GOOFY_PROFILE builds), nothing is printed for other encoders
+void printProfileCounters()
 {
-    memset(rgba8, 0, width * height * 4);
-    uint32_t blockW = width / 4;
-    uint32_t blockH = height / 4;
-    uint32_t stride = width * 4;
-    for (uint32_t by = 0; by < blockH; by++)
+    const goofy::ProfileCounters counters = goofy::getProfileCounters();
+    if (counters.numStrips == 0)
     {
-        for (uint32_t bx = 0; bx < blockW; bx++)
-        {
-            uint32_t x = bx * 4;
-            uint32_t y = by * 4;
-            DecoderBC::decodeBlockDXT5(data, rgba8 + (y * width + x) * 4, stride);
-            data += 16;
-        }
+        return;
     }
+
+    const double numberOfBlocks = double(counters.numStrips) * 4.0;
+    printf("ticks/block: fetch %.2f, min/max %.2f, quantize %.2f, error %.2f, finalize %.2f, image (outer loops) %.2f\n", double(counters.fetchTicks) / numberOfBlocks,
+           double(counters.minMaxTicks) / numberOfBlocks, double(counters.quantizeTicks) / numberOfBlocks, double(counters.errorTicks) / numberOfBlocks,
+           double(counters.finalizeTicks) / numberOfBlocks, double(counters.imageTicks) / numberOfBlocks);
 }
+#endif
 
-void decompressETC1(const unsigned char* data, uint32_t width, uint32_t height, unsigned char* rgba8)
+#ifdef ENABLE_PERF_COUNTERS
+// opened once per process, prints a message if counters can't be used (non-Linux, containers, perf_event_paranoid)
+PerfCounters& getPerfCounters()
 {
-    memset(rgba8, 0, width * height * 4);
-    uint32_t blockW = width / 4;
-    uint32_t blockH = height / 4;
-    uint32_t stride = width * 4;
-    for (uint32_t by = 0; by < blockH; by++)
+    static PerfCounters perfCounters;
+    static bool isReported = false;
+    if (!isReported)
     {
-        for (uint32_t bx = 0; bx < blockW; bx++)
+        isReported = true;
+        if (!perfCounters.isAvailable())
         {
-            uint32_t x = bx * 4;
-            uint32_t y = by * 4;
-            DecoderBC::decodeBlockETC1(data, rgba8 + (y * width + x) * 4, stride);
-            data += 8;
+            printf("Hardware performance counters are not available, perf columns will be 'n/a'\n");
         }
     }
+    return perfCounters;
 }
 
-void decompressETC2(const unsigned char* data, uint32_t width, uint32_t height, unsigned char* rgba8)
+static double getPerfCounterRatio(const PerfCounters& counters, PerfCounters::Counter counter, double denominator)
 {
-    memset(rgba8, 0, width * height * 4);
-    uint32_t blockW = width / 4;
-    uint32_t blockH = height / 4;
-    uint32_t stride = width * 4;
-    for (uint32_t by = 0; by < blockH; by++)
+    if (!counters.isCounterAvailable(counter) || denominator <= 0.0)
     {
-        for (uint32_t bx = 0; bx < blockW; bx++)
-        {
-            uint32_t x = bx * 4;
-            uint32_t y = by * 4;
-            DecoderBC::decodeBlockETC2(data, rgba8 + (y * width + x) * 4, stride);
-            data += 16;
-        }
+        return -1.0;
     }
+    return double(counters.getValue(counter)) / denominator;
 }
 
-// ============================================================================================
+PerfCounterStats computePerfCounterStats(const PerfCounters& counters, unsigned int numberOfIterations, unsigned int w, unsigned int h)
+{
+    PerfCounterStats stats;
+    const uint64_t cycles = counters.getValue(PerfCounters::COUNTER_CYCLES);
+    if (!counters.isAvailable() || cycles == 0)
+    {
+        return stats;
+    }
 
-struct TestResult
+    const double numberOfBlocks = double(w / 4) * double(h / 4) * double(numberOfIterations);
+    stats.isAvailable = true;
+    stats.ipc = getPerfCounterRatio(counters, PerfCounters::COUNTER_INSTRUCTIONS, double(cycles));
+    stats.cyclesPerBlock = double(cycles) / numberOfBlocks;
+    stats.l1dMissesPerBlock = getPerfCounterRatio(counters, PerfCounters::COUNTER_L1D_MISSES, numberOfBlocks);
+    stats.llcMissesPerBlock = getPerfCounterRatio(counters, PerfCounters::COUNTER_LLC_MISSES, numberOfBlocks);
+    stats.branchMissesPerBlock = getPerfCounterRatio(counters, PerfCounters::COUNTER_BRANCH_MISSES, numberOfBlocks);
+    return stats;
+}
+
+static std::string perfValueToString(double v)
 {
-    std::string encoderName;
-    std::string format;
-    double numberOfPixels;
-    double timeInMicroSeconds;
-    MsePsnr msePsnr;
-};
+    if (v < 0.0)
+    {
+        return "n/a";
+    }
+    sprintf(printBuffer, "%1.4f", v);
+    return printBuffer;
+}
 
-typedef int (__cdecl* CompressFunc_t)(unsigned char *dst, const unsigned char *src, unsigned int width, unsigned int height, unsigned int stride);
+// extra results.txt columns (starts with ';')
+std::string formatPerfCounters(const PerfCounterStats& perf)
+{
+    std::string res;
+    res += ";" + perfValueToString(perf.ipc);
+    res += ";" + perfValueToString(perf.cyclesPerBlock);
+    res += ";" + perfValueToString(perf.l1dMissesPerBlock);
+    res += ";" + perfValueToString(perf.llcMissesPerBlock);
+    res += ";" + perfValueToString(perf.branchMissesPerBlock);
+    return res;
+}
+#endif
+
+// Run encoder numberOfIterations times (after warmup), every run is timed with ns resolution
+// Hardware counters are collected around the same runs if perfStats is not null (ENABLE_PERF_COUNTERS builds only)
+BenchmarkStats benchmarkCompressFunc(CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char* dst, const unsigned char* src, unsigned int w,
+                                     unsigned int h, unsigned int stride
+#ifdef ENABLE_PERF_COUNTERS
+                                     , PerfCounterStats* perfStats = nullptr
+#endif
+                                     )
+{
+    for (int iter = 0; iter < kNumberOfWarmupIterations; iter++)
+    {
+        func(dst, src, w, h, stride);
+    }
+
+#ifdef GOOFY_PROFILE
+    goofy::resetProfileCounters();
+#endif
+
+#ifdef ENABLE_PERF_COUNTERS
+    PerfCounters& perfCounters = getPerfCounters();
+    perfCounters.reset();
+#endif
+
+    std::vector<double> samplesNs;
+    samplesNs.reserve(numberOfIterations);
+    for (unsigned int iter = 0; iter < numberOfIterations; iter++)
+    {
+#ifdef ENABLE_PERF_COUNTERS
+        // outside of the timed region: ioctl cost must not affect timings
+        perfCounters.start();
+#endif
+        timer.begin();
+        func(dst, src, w, h, stride);
+        samplesNs.push_back(double(timer.endNs()));
+#ifdef ENABLE_PERF_COUNTERS
+        perfCounters.stop();
+#endif
+    }
+
+#ifdef ENABLE_PERF_COUNTERS
+    if (perfStats)
+    {
+        *perfStats = computePerfCounterStats(perfCounters, numberOfIterations, w, h);
+        if (perfStats->isAvailable)
+        {
+            printf("IPC %s, cycles/block %s, L1D misses/block %s, LLC misses/block %s, branch misses/block %s\n", perfValueToString(perfStats->ipc).c_str(),
+                   perfValueToString(perfStats->cyclesPerBlock).c_str(), perfValueToString(perfStats->l1dMissesPerBlock).c_str(),
+                   perfValueToString(perfStats->llcMissesPerBlock).c_str(), perfValueToString(perfStats->branchMissesPerBlock).c_str());
+        }
+    }
+#endif
+
+#ifdef GOOFY_PROFILE
+    printProfileCounters();
+#endif
+
+    BenchmarkStats stats = computeBenchmarkStats(samplesNs);
+#ifdef ENABLE_ROBUST_BENCHMARK
+    const double numberOfPixels = double(w) * double(h);
+    printf("median %.0f ns (%3.2f MP/s), p90 %.0f ns, p99 %.0f ns, MAD %.0f ns (%1.2f%%)\n", stats.medianNs, numberOfPixels * 1000.0 / stats.medianNs, stats.p90Ns,
+           stats.p99Ns, stats.madNs, 100.0 * stats.madNs / stats.medianNs);
+#endif
+    return stats;
+}
 
 TestResult runTestDXT1(const char* encoderName, const char* imageName, CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char *dst, size_t dstSize, unsigned char* src, unsigned int w, unsigned int h, unsigned int stride, unsigned char* scratch)
 {
     std::cout << "DXT1 Encoder: " << imageName << "(" << encoderName << ")" << std::endl;
 
     memset(dst, 0, dstSize);
-  
+
+#ifdef ENABLE_PERF_COUNTERS
+    PerfCounterStats perf;
+    const BenchmarkStats timing = benchmarkCompressFunc(func, timer, numberOfIterations, dst, src, w, h, stride, &perf);
+#else
+    const BenchmarkStats timing = benchmarkCompressFunc(func, timer, numberOfIterations, dst, src, w, h, stride);
+#endif
+
+    DecoderBC::decompressDXT1(dst, w, h, scratch, w * 4);
+    MsePsnr msePsnr = getMsePsnr(src, scratch, w, h);
+
+    char fileName[256];
+    fileName[0] = '\0';
+    strcpy(fileName, "./test-results/");
+    strcat(fileName, imageName);
+    strcat(fileName, "_");
+    strcat(fileName, encoderName);
+    strcat(fileName, "_dxt1_decompressed.tga");
+    saveTga(fileName, scratch, w, h);
+
+    fileName[0] = '\0';
+    strcpy(fileName, "./test-results/");
+    strcat(fileName, imageName);
+    strcat(fileName, "_");
+    strcat(fileName, encoderName);
+    strcat(fileName, "_dxt1.dds");
+    saveDds(fileName, dst, dstSize, w, h, kDdsFormatDXT1);
+
+    TestResult res;
+    res.encoderName = encoderName;
+    res.format = "DXT1";
+    res.msePsnr = msePsnr;
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
+    res.numberOfPixels = (w * h);
+    res.timeInMicroSeconds = timing.minNs / 1000.0;
+    res.timing = timing;
+#ifdef ENABLE_PERF_COUNTERS
+    res.perf = perf;
+#endif
+    return res;
+}
+
+TestResult runTestETC1(const char* encoderName, const char* imageName, CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char *dst, size_t dstSize, unsigned char* src,  unsigned int w, unsigned int h, unsigned int stride, unsigned char* scratch)
+{
+    std::cout << "ETC1 Encoder: " << imageName << "(" << encoderName << ")" << std::endl;
+
+    memset(dst, 0, dstSize);
+
+#ifdef ENABLE_PERF_COUNTERS
+    PerfCounterStats perf;
+    const BenchmarkStats timing = benchmarkCompressFunc(func, timer, numberOfIterations, dst, src, w, h, stride, &perf);
+#else
+    const BenchmarkStats timing = benchmarkCompressFunc(func, timer, numberOfIterations, dst, src, w, h, stride);
+#endif
+
+    DecoderBC::decompressETC1(dst, w, h, scratch, w * 4);
+    MsePsnr msePsnr = getMsePsnr(src, scratch, w, h);
+
+    char fileName[256];
+    fileName[0] = '\0';
+    strcpy(fileName, "./test-results/");
+    strcat(fileName, imageName);
+    strcat(fileName, "_");
+    strcat(fileName, encoderName);
+    strcat(fileName, "_etc1_decompressed.tga");
+    saveTga(fileName, scratch, w, h);
+
+    fileName[0] = '\0';
+    strcpy(fileName, "./test-results/");
+    strcat(fileName, imageName);
+    strcat(fileName, "_");
+    strcat(fileName, encoderName);
+    strcat(fileName, "_etc1.ktx");
+    saveKtx(fileName, dst, dstSize, w, h, kKtxFormatETC1);
+
+    TestResult res;
+    res.encoderName = encoderName;
+    res.format = "ETC1";
+    res.msePsnr = msePsnr;
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
+    res.numberOfPixels = (w * h);
+    res.timeInMicroSeconds = timing.minNs / 1000.0;
+    res.timing = timing;
+#ifdef ENABLE_PERF_COUNTERS
+    res.perf = perf;
+#endif
+    return res;
+}
+
+typedef int (__cdecl* TranscodeFunc_t)(unsigned char *dst, const unsigned char *src, unsigned int width, unsigned int height);
+
+TestResult runTestTranscodeDXT1(const char* encoderName, const char* imageName, TranscodeFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char *dst, size_t dstSize, const unsigned char* compressedSrc, const unsigned char* src, unsigned int w, unsigned int h, unsigned char* scratch)
+{
+    std::cout << "DXT1 Transcoder: " << imageName << "(" << encoderName << ")" << std::endl;
+
+    memset(dst, 0, dstSize);
+
     double bestTimeUs = DBL_MAX;
     for (unsigned int iter = 0; iter < numberOfIterations; iter++)
     {
         timer.begin();
-        func(dst, src, w, h, stride);
+        func(dst, compressedSrc, w, h);
         double iterationTimeUs = timer.end();
 
         if (iterationTimeUs < bestTimeUs)
         {
             bestTimeUs = iterationTimeUs;
-            //printf("%s %3.0f us\r", encoderName, bestTimeUs);
         }
     }
-    //printf("\n");
 
-    decompressDXT1(dst, w, h, scratch);
+    DecoderBC::decompressDXT1(dst, w, h, scratch, w * 4);
     MsePsnr msePsnr = getMsePsnr(src, scratch, w, h);
 
     char fileName[256];
@@ -688,32 +1070,32 @@ TestResult runTestDXT1(const char* encoderName, const char* imageName, CompressF
     res.encoderName = encoderName;
     res.format = "DXT1";
     res.msePsnr = msePsnr;
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
     res.numberOfPixels = (w * h);
     res.timeInMicroSeconds = bestTimeUs;
     return res;
 }
 
-TestResult runTestETC1(const char* encoderName, const char* imageName, CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char *dst, size_t dstSize, unsigned char* src,  unsigned int w, unsigned int h, unsigned int stride, unsigned char* scratch)
+TestResult runTestTranscodeETC1(const char* encoderName, const char* imageName, TranscodeFunc_t func, Timer& timer, unsigned int numberOfIterations, unsigned char *dst, size_t dstSize, const unsigned char* compressedSrc, const unsigned char* src, unsigned int w, unsigned int h, unsigned char* scratch)
 {
-    std::cout << "ETC1 Encoder: " << imageName << "(" << encoderName << ")" << std::endl;
+    std::cout << "ETC1 Transcoder: " << imageName << "(" << encoderName << ")" << std::endl;
 
     memset(dst, 0, dstSize);
+
     double bestTimeUs = DBL_MAX;
     for (unsigned int iter = 0; iter < numberOfIterations; iter++)
     {
         timer.begin();
-        func(dst, src, w, h, stride);
+        func(dst, compressedSrc, w, h);
         double iterationTimeUs = timer.end();
 
         if (iterationTimeUs < bestTimeUs)
         {
             bestTimeUs = iterationTimeUs;
-            //printf("%s %3.0f us\r", encoderName, bestTimeUs);
         }
     }
-    //printf("\n");
 
-    decompressETC1(dst, w, h, scratch);
+    DecoderBC::decompressETC1(dst, w, h, scratch, w * 4);
     MsePsnr msePsnr = getMsePsnr(src, scratch, w, h);
 
     char fileName[256];
@@ -737,6 +1119,36 @@ TestResult runTestETC1(const char* encoderName, const char* imageName, CompressF
     res.encoderName = encoderName;
     res.format = "ETC1";
     res.msePsnr = msePsnr;
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
+    res.numberOfPixels = (w * h);
+    res.timeInMicroSeconds = bestTimeUs;
+    return res;
+}
+
+typedef void (*DecompressFunc_t)(const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba8, size_t rgba8Stride, unsigned int numThreads);
+
+TestResult runTestDecode(const char* decoderName, const char* format, const char* imageName, DecompressFunc_t func, Timer& timer, unsigned int numberOfIterations, const unsigned char* compressedSrc, const unsigned char* src, unsigned int w, unsigned int h, unsigned char* scratch)
+{
+    std::cout << format << " Decoder: " << imageName << "(" << decoderName << ")" << std::endl;
+
+    double bestTimeUs = DBL_MAX;
+    for (unsigned int iter = 0; iter < numberOfIterations; iter++)
+    {
+        timer.begin();
+        func(compressedSrc, w, h, scratch, w * 4, 0);
+        double iterationTimeUs = timer.end();
+
+        if (iterationTimeUs < bestTimeUs)
+        {
+            bestTimeUs = iterationTimeUs;
+        }
+    }
+
+    TestResult res;
+    res.encoderName = decoderName;
+    res.format = format;
+    res.msePsnr = getMsePsnr(src, scratch, w, h);
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
     res.numberOfPixels = (w * h);
     res.timeInMicroSeconds = bestTimeUs;
     return res;
@@ -763,6 +1175,25 @@ int rygCompressDXT1(unsigned char *dst, const unsigned char *src, unsigned int w
     return 0;
 }
 
+int rygCompressDXT5(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    unsigned char block[64];
+    for (unsigned int y = 0; y < h; y += 4)
+    {
+        for (unsigned int x = 0; x < w; x += 4)
+        {
+            const unsigned char * p = src + ((y * w + x) * 4);
+            memcpy(&block[0], p, 16);
+            memcpy(&block[16], p + stride, 16);
+            memcpy(&block[32], p + stride * 2, 16);
+            memcpy(&block[48], p + stride * 3, 16);
+            stb_compress_dxt_block(dst, block, 1, STB_DXT_NORMAL);
+            dst += 16;
+        }
+    }
+    return 0;
+}
+
 int icbcCompressDXT1(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
 {
     icbc::init_dxt1();
@@ -831,6 +1262,917 @@ int rgCompressETC1(unsigned char *dst, const unsigned char *src, unsigned int w,
     return 0;
 }
 
+// intermediate RGBA image of decodeAndCompressETC1 (w * h * 4 bytes), allocated outside of the timed region
+static unsigned char* gDecodeRgbaBuffer = nullptr;
+
+// decode + encode baseline for the transcoders (single threaded, like the transcoders)
+int decodeAndCompressETC1(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h)
+{
+    DecoderBC::decompressDXT1(src, w, h, gDecodeRgbaBuffer, w * 4, 1);
+    return goofy::compressETC1(dst, gDecodeRgbaBuffer, w, h, w * 4);
+}
+
+// per-block error map of the last goofy*WithErrorMap call
+static std::vector<uint32_t> gErrorMap;
+
+int goofyCompressDXT1WithErrorMap(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    gErrorMap.resize(size_t(w / 4) * size_t(h / 4));
+    return goofy::compressDXT1WithErrorMap(dst, src, w, h, stride, gErrorMap.data());
+}
+
+int goofyCompressETC1WithErrorMap(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    gErrorMap.resize(size_t(w / 4) * size_t(h / 4));
+    return goofy::compressETC1WithErrorMap(dst, src, w, h, stride, gErrorMap.data());
+}
+
+// high quality block encoders for the hybrid mode
+void rygEncodeBlockDXT1(unsigned char* result, const unsigned char* rgba, void* /*userData*/)
+{
+    stb_compress_dxt_block(result, rgba, 0, STB_DXT_NORMAL);
+}
+
+void icbcEncodeBlockDXT1(unsigned char* result, const unsigned char* rgba, void* /*userData*/)
+{
+    icbc::compress_dxt1_fast(rgba, result);
+}
+
+void rgEncodeBlockETC1(unsigned char* result, const unsigned char* rgba, void* userData)
+{
+    rg_etc1::etc1_pack_params* params = (rg_etc1::etc1_pack_params*)userData;
+    rg_etc1::pack_etc1_block(result, (const unsigned int*)rgba, *params);
+}
+
+// one-time initialization of the global tables used by the block encoders above
+// (must be done before the block encoders are called from several threads at once)
+void rygInitDXT1()
+{
+    // stb_dxt initializes its tables on the first block
+    unsigned char block[64] = {};
+    unsigned char result[8];
+    rygEncodeBlockDXT1(result, block, nullptr);
+}
+
+void rgInitETC1()
+{
+    rg_etc1::pack_etc1_block_init();
+}
+
+template<unsigned int WORST_BLOCKS_PERCENT>
+int hybridRygCompressDXT1(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    gErrorMap.resize(size_t(w / 4) * size_t(h / 4));
+    int res = goofy::compressDXT1Hybrid(dst, src, w, h, stride, gErrorMap.data(), rygEncodeBlockDXT1, nullptr, 0, WORST_BLOCKS_PERCENT);
+    return (res < 0) ? res : 0;
+}
+
+template<unsigned int WORST_BLOCKS_PERCENT>
+int hybridIcbcCompressDXT1(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    icbc::init_dxt1();
+    gErrorMap.resize(size_t(w / 4) * size_t(h / 4));
+    int res = goofy::compressDXT1Hybrid(dst, src, w, h, stride, gErrorMap.data(), icbcEncodeBlockDXT1, nullptr, 0, WORST_BLOCKS_PERCENT);
+    return (res < 0) ? res : 0;
+}
+
+template<unsigned int WORST_BLOCKS_PERCENT>
+int hybridRgCompressETC1(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    rg_etc1::etc1_pack_params params;
+    params.clear();
+    rg_etc1::pack_etc1_block_init();
+    params.m_quality = rg_etc1::cLowQuality;
+    params.m_dithering = false;
+
+    gErrorMap.resize(size_t(w / 4) * size_t(h / 4));
+    int res = goofy::compressETC1Hybrid(dst, src, w, h, stride, gErrorMap.data(), rgEncodeBlockETC1, &params, 0, WORST_BLOCKS_PERCENT);
+    return (res < 0) ? res : 0;
+}
+
+// Progressive encoding as seen by an editor: upload the fast result, then poll and upload refined tiles until finished
+// time = time to the fully refined texture
+// initSlowEncoder (optional) is called once before the refinement: slowEncoder runs on several worker threads at once
+TestResult runTestProgressive(const char* encoderName, const char* format, const char* imageName, ProgressiveEncoder::CompressFunc fastEncoder, ProgressiveEncoder::EncodeBlockFunc slowEncoder, void (*initSlowEncoder)(), void* userData, Timer& timer, unsigned char *dst, size_t dstSize, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride, unsigned char* scratch)
+{
+    std::cout << format << " Progressive: " << imageName << "(" << encoderName << ")" << std::endl;
+
+    // dst = GPU copy of the texture
+    memset(dst, 0, dstSize);
+    const unsigned int blocksW = w / 4;
+    const size_t pitch = size_t(blocksW) * 8;
+
+    ProgressiveEncoder encoder;
+    std::vector<ProgressiveEncoder::Tile> tiles;
+    uint64_t version = 0;
+    size_t numUploadedTiles = 0;
+    size_t numPolls = 0;
+
+    if (initSlowEncoder)
+    {
+        initSlowEncoder();
+    }
+
+    timer.begin();
+    encoder.start(src, w, h, stride, fastEncoder, slowEncoder, userData);
+    double firstResultUs = (double)timer.end();
+
+    bool isFinished = false;
+    do
+    {
+        // check before polling to not miss the last tiles
+        isFinished = encoder.isFinished();
+
+        tiles.clear();
+        version = encoder.getDirtyTiles(version, tiles);
+        for (const ProgressiveEncoder::Tile& tile : tiles)
+        {
+            encoder.copyTile(tile, dst + size_t(tile.y) * pitch + size_t(tile.x) * 8, pitch);
+        }
+        numUploadedTiles += tiles.size();
+        numPolls++;
+
+        if (!isFinished)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } while (!isFinished);
+    double refinedUs = (double)timer.end();
+
+    // the refined texture should be identical to the slow encoder output
+    bool isIdentical = true;
+    unsigned char block[64];
+    unsigned char encodedBlock[8];
+    for (unsigned int y = 0; y < h && isIdentical; y += 4)
+    {
+        for (unsigned int x = 0; x < w; x += 4)
+        {
+            const unsigned char* p = src + size_t(y) * stride + size_t(x) * 4;
+            memcpy(&block[0], p, 16);
+            memcpy(&block[16], p + stride, 16);
+            memcpy(&block[32], p + stride * 2, 16);
+            memcpy(&block[48], p + stride * 3, 16);
+            slowEncoder(encodedBlock, block, userData);
+            if (memcmp(encodedBlock, dst + size_t(y / 4) * pitch + size_t(x / 4) * 8, 8) != 0)
+            {
+                isIdentical = false;
+                break;
+            }
+        }
+    }
+    printf("%s %s progressive: first result %3.0f us, refined %3.0f us, %d tiles uploaded in %d polls, identical to slow encoder: %s\n", encoderName, format, firstResultUs, refinedUs, (int)numUploadedTiles, (int)numPolls, isIdentical ? "yes" : "no");
+
+    if (strcmp(format, "DXT1") == 0)
+    {
+        DecoderBC::decompressDXT1(dst, w, h, scratch, w * 4);
+    }
+    else
+    {
+        DecoderBC::decompressETC1(dst, w, h, scratch, w * 4);
+    }
+
+    TestResult res;
+    res.encoderName = encoderName;
+    res.format = format;
+    res.msePsnr = getMsePsnr(src, scratch, w, h);
+    res.ssim = Ssim::computeSsim(src, scratch, w, h);
+    res.numberOfPixels = (w * h);
+    res.timeInMicroSeconds = refinedUs;
+    return res;
+}
+
+// Encode the whole image as a set of unaligned regions (e.g. brush strokes)
+template<int (*COMPRESS_REGION)(unsigned char*, unsigned int, const unsigned char*, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int)>
+int regionCompress(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const unsigned int kRegionWidth = 54;
+    const unsigned int kRegionHeight = 38;
+    const unsigned int dstPitch = (w / 4) * 8;
+    for (unsigned int y = 0; y < h; y += kRegionHeight)
+    {
+        for (unsigned int x = 0; x < w; x += kRegionWidth)
+        {
+            COMPRESS_REGION(dst, dstPitch, src, stride, w, h, x, y, std::min(kRegionWidth, w - x), std::min(kRegionHeight, h - y));
+        }
+    }
+    return 0;
+}
+
+// Re-encode a small region and make sure only the affected blocks are written and match the whole image encoding
+template<int (*COMPRESS_REGION)(unsigned char*, unsigned int, const unsigned char*, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int)>
+void checkRegionEncode(const char* format, CompressFunc_t compressImage, Timer& timer, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const unsigned int x = 37;
+    const unsigned int y = 21;
+    if (w <= x || h <= y)
+    {
+        return;
+    }
+
+    const unsigned int blocksW = w / 4;
+    const unsigned int blocksH = h / 4;
+    const unsigned int dstPitch = blocksW * 8;
+    std::vector<unsigned char> reference(size_t(dstPitch) * blocksH);
+    std::vector<unsigned char> blocks(size_t(dstPitch) * blocksH, 0);
+
+    timer.begin();
+    compressImage(reference.data(), src, w, h, stride);
+    double imageTimeUs = (double)timer.end();
+
+    const unsigned int regionW = std::min(101u, w - x);
+    const unsigned int regionH = std::min(43u, h - y);
+    timer.begin();
+    int res = COMPRESS_REGION(blocks.data(), dstPitch, src, stride, w, h, x, y, regionW, regionH);
+    double regionTimeUs = (double)timer.end();
+
+    // a region outside of the image must be rejected
+    bool isValid = (res == 0) && (COMPRESS_REGION(blocks.data(), dstPitch, src, stride, w, h, x, y, w, regionH) == -3);
+    for (unsigned int by = 0; by < blocksH; by++)
+    {
+        for (unsigned int bx = 0; bx < blocksW; bx++)
+        {
+            const bool isInside = (bx >= x / 4) && (bx < (x + regionW + 3) / 4) && (by >= y / 4) && (by < (y + regionH + 3) / 4);
+            const size_t offset = size_t(by) * dstPitch + size_t(bx) * 8;
+            static const unsigned char kZero[8] = {};
+            if (memcmp(&blocks[offset], isInside ? &reference[offset] : kZero, 8) != 0)
+            {
+                isValid = false;
+            }
+        }
+    }
+    printf("%s region %ux%u at (%u, %u): %3.0f us (whole image %3.0f us), valid: %s\n", format, regionW, regionH, x, y, regionTimeUs, imageTimeUs, isValid ? "yes" : "no");
+}
+
+// Encode a sequence of frames (a small moving square over the test image) with the temporal encoder
+// and make sure the results are identical to encoding every frame from scratch
+typedef int (__cdecl* TemporalCompressFunc_t)(unsigned char *dst, const unsigned char *src, unsigned int width, unsigned int height, unsigned int stride, uint64_t* stripHashes, uint32_t* changedStrips);
+
+// returns false if the temporal encoder results are not identical
+bool runTestTemporal(const char* format, TemporalCompressFunc_t temporalFunc, CompressFunc_t func, Timer& timer, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const unsigned int kNumberOfFrames = 32;
+    const unsigned int kSquareSize = 48;
+    if (w <= kSquareSize || h <= kSquareSize)
+    {
+        return true;
+    }
+
+    const size_t frameSize = size_t(stride) * h;
+#ifdef _WIN32
+    unsigned char* frame = (unsigned char*) _aligned_malloc(frameSize, 64);
+#else
+    unsigned char* frame = (unsigned char*) aligned_alloc(64, frameSize);
+#endif
+    memcpy(frame, src, frameSize);
+
+    const size_t compressedSize = size_t(w / 4) * size_t(h / 4) * 8;
+    const size_t numStrips = size_t(w / 16) * size_t(h / 4);
+    std::vector<unsigned char> blocks(compressedSize);
+    std::vector<unsigned char> reference(compressedSize);
+    std::vector<uint64_t> stripHashes(numStrips, 0);
+    std::vector<uint32_t> changedStrips((numStrips + 31) / 32);
+
+    double temporalTimeUs = 0.0;
+    double fullTimeUs = 0.0;
+    size_t numChangedStrips = 0;
+    bool isIdentical = true;
+    for (unsigned int i = 0; i < kNumberOfFrames; i++)
+    {
+        // invert a moving square
+        memcpy(frame, src, frameSize);
+        const unsigned int squareX = (i * 29) % (w - kSquareSize);
+        const unsigned int squareY = (i * 17) % (h - kSquareSize);
+        for (unsigned int y = squareY; y < squareY + kSquareSize; y++)
+        {
+            for (unsigned int x = squareX * 4; x < (squareX + kSquareSize) * 4; x++)
+            {
+                frame[size_t(y) * stride + x] ^= 0xFF;
+            }
+        }
+
+        timer.begin();
+        int res = temporalFunc(blocks.data(), frame, w, h, stride, stripHashes.data(), changedStrips.data());
+        temporalTimeUs += (double)timer.end();
+        numChangedStrips += (i == 0) ? 0 : size_t(std::max(res, 0));
+
+        timer.begin();
+        func(reference.data(), frame, w, h, stride);
+        fullTimeUs += (double)timer.end();
+
+        isIdentical = isIdentical && (blocks == reference);
+    }
+
+#ifdef _WIN32
+    _aligned_free(frame);
+#else
+    free(frame);
+#endif
+
+    printf("%s temporal: %u frames, changed strips %2.2f%%, %3.0f us/frame (full encode %3.0f us/frame), identical: %s\n", format, kNumberOfFrames,
+           100.0 * double(numChangedStrips) / (double(numStrips) * (kNumberOfFrames - 1)), temporalTimeUs / kNumberOfFrames, fullTimeUs / kNumberOfFrames, isIdentical ? "yes" : "no");
+    return isIdentical;
+}
+
+// Deduplication mode: the cache is created outside of the timed region and kept between calls (new cache per image)
+static goofy::BlockCache* gDedupCache = nullptr;
+// block lookups and hits of the last dedupCompress call
+static uint64_t gDedupLookups = 0;
+static uint64_t gDedupHits = 0;
+
+template<int (*COMPRESS_DEDUP)(unsigned char*, const unsigned char*, unsigned int, unsigned int, unsigned int, goofy::BlockCache*)>
+int dedupCompress(unsigned char *dst, const unsigned char *src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    uint64_t lookupsBefore = 0;
+    uint64_t hitsBefore = 0;
+    goofy::getBlockCacheStats(gDedupCache, &lookupsBefore, &hitsBefore);
+    int res = COMPRESS_DEDUP(dst, src, w, h, stride, gDedupCache);
+    goofy::getBlockCacheStats(gDedupCache, &gDedupLookups, &gDedupHits);
+    gDedupLookups -= lookupsBefore;
+    gDedupHits -= hitsBefore;
+    return res;
+}
+
+static double getDedupHitRate()
+{
+    return 100.0 * double(gDedupHits) / double(std::max(gDedupLookups, uint64_t(1)));
+}
+
+// Build a tile map (repeated 32x32 tiles of the test image) and compare the dedup mode with the regular encoder
+// returns false if the dedup results are not identical
+bool runTestDedup(const char* format, CompressFunc_t dedupFunc, CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const unsigned int kTileSize = 32;
+    const unsigned int kNumTiles = 16;
+    const unsigned int kMapSize = 1024;
+    if (w < kTileSize * kNumTiles || h < kTileSize)
+    {
+        return true;
+    }
+
+    const size_t mapStride = kMapSize * 4;
+    const size_t mapSize = mapStride * kMapSize;
+#ifdef _WIN32
+    unsigned char* map = (unsigned char*) _aligned_malloc(mapSize, 64);
+#else
+    unsigned char* map = (unsigned char*) aligned_alloc(64, mapSize);
+#endif
+    uint32_t rnd = 12345;
+    for (unsigned int ty = 0; ty < kMapSize / kTileSize; ty++)
+    {
+        for (unsigned int tx = 0; tx < kMapSize / kTileSize; tx++)
+        {
+            rnd = rnd * 1103515245 + 12345;
+            const unsigned int tile = (rnd >> 16) % kNumTiles;
+            for (unsigned int y = 0; y < kTileSize; y++)
+            {
+                memcpy(map + (ty * kTileSize + y) * mapStride + tx * kTileSize * 4, src + size_t(y) * stride + tile * kTileSize * 4, kTileSize * 4);
+            }
+        }
+    }
+
+    const size_t compressedSize = size_t(kMapSize / 4) * size_t(kMapSize / 4) * 8;
+    std::vector<unsigned char> blocks(compressedSize);
+    std::vector<unsigned char> reference(compressedSize);
+
+    // first call with an empty cache (untimed), timed calls reuse the cache
+    gDedupCache = goofy::createBlockCache();
+    dedupFunc(blocks.data(), map, kMapSize, kMapSize, (unsigned int)mapStride);
+    const double firstCallHitRate = getDedupHitRate();
+
+    double bestDedupTimeUs = DBL_MAX;
+    double bestTimeUs = DBL_MAX;
+    for (unsigned int iter = 0; iter < numberOfIterations; iter++)
+    {
+        timer.begin();
+        dedupFunc(blocks.data(), map, kMapSize, kMapSize, (unsigned int)mapStride);
+        bestDedupTimeUs = std::min(bestDedupTimeUs, (double)timer.end());
+
+        timer.begin();
+        func(reference.data(), map, kMapSize, kMapSize, (unsigned int)mapStride);
+        bestTimeUs = std::min(bestTimeUs, (double)timer.end());
+    }
+    const double laterCallsHitRate = getDedupHitRate();
+    goofy::destroyBlockCache(gDedupCache);
+    gDedupCache = nullptr;
+
+#ifdef _WIN32
+    _aligned_free(map);
+#else
+    free(map);
+#endif
+
+    const double numberOfPixels = double(kMapSize) * double(kMapSize);
+    const bool isIdentical = (blocks == reference);
+    printf("%s dedup (tile map %ux%u, %u unique tiles): blocks from cache %2.2f%% (cache kept between calls %2.2f%%), %3.2f MP/s (regular %3.2f MP/s), identical: %s\n",
+           format, kMapSize, kMapSize, kNumTiles, firstCallHitRate, laterCallsHitRate, numberOfPixels / bestDedupTimeUs, numberOfPixels / bestTimeUs, isIdentical ? "yes" : "no");
+    return isIdentical;
+}
+
+// 2x2 box filter
+void downsampleRgba8(unsigned char* dst, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    for (unsigned int y = 0; y < h / 2; y++)
+    {
+        const unsigned char* row0 = src + size_t(y * 2) * stride;
+        const unsigned char* row1 = row0 + stride;
+        for (unsigned int x = 0; x < (w / 2) * 4; x++)
+        {
+            const unsigned int i = (x / 4) * 8 + (x % 4);
+            dst[size_t(y) * (w / 2) * 4 + x] = (unsigned char)((row0[i] + row0[i + 4] + row1[i] + row1[i + 4] + 2) / 4);
+        }
+    }
+}
+
+typedef int (__cdecl* TransformFunc_t)(unsigned char *dst, const unsigned char *src, unsigned int width, unsigned int height, goofy::GoofyTransform transform);
+
+// Compare compressed-domain transforms and block copies with the same operations on the decoded image (must be exact)
+// returns false if the results are not exact
+bool runTestTransform(const char* format, TransformFunc_t transformFunc, CompressFunc_t func, DecompressFunc_t decompressFunc, Timer& timer, unsigned int numberOfIterations,
+                      const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const size_t compressedSize = size_t(w / 4) * size_t(h / 4) * 8;
+    std::vector<unsigned char> blocks(compressedSize);
+    std::vector<unsigned char> transformed(compressedSize);
+    std::vector<uint32_t> decoded(size_t(w) * h);
+    std::vector<uint32_t> result(size_t(w) * h);
+
+    func(blocks.data(), src, w, h, stride);
+    decompressFunc(blocks.data(), w, h, (unsigned char*)decoded.data(), size_t(w) * 4, 0);
+
+    const goofy::GoofyTransform transforms[] = {goofy::GOOFY_FLIP_X, goofy::GOOFY_FLIP_Y, goofy::GOOFY_ROTATE_90_CW, goofy::GOOFY_ROTATE_180, goofy::GOOFY_ROTATE_90_CCW};
+    bool isExact = true;
+    double bestTimeUs = DBL_MAX;
+    for (goofy::GoofyTransform transform : transforms)
+    {
+        const bool isRotated = (transform == goofy::GOOFY_ROTATE_90_CW || transform == goofy::GOOFY_ROTATE_90_CCW);
+        const unsigned int resW = isRotated ? h : w;
+        const unsigned int resH = isRotated ? w : h;
+        for (unsigned int i = 0; i < numberOfIterations; i++)
+        {
+            timer.begin();
+            transformFunc(transformed.data(), blocks.data(), w, h, transform);
+            bestTimeUs = std::min(bestTimeUs, (double)timer.end());
+        }
+
+        decompressFunc(transformed.data(), resW, resH, (unsigned char*)result.data(), size_t(resW) * 4, 0);
+        for (unsigned int y = 0; y < h; y++)
+        {
+            for (unsigned int x = 0; x < w; x++)
+            {
+                size_t dstIndex = 0;
+                switch (transform)
+                {
+                case goofy::GOOFY_FLIP_X: dstIndex = size_t(y) * resW + (w - 1 - x); break;
+                case goofy::GOOFY_FLIP_Y: dstIndex = size_t(h - 1 - y) * resW + x; break;
+                case goofy::GOOFY_ROTATE_90_CW: dstIndex = size_t(x) * resW + (h - 1 - y); break;
+                case goofy::GOOFY_ROTATE_180: dstIndex = size_t(h - 1 - y) * resW + (w - 1 - x); break;
+                default: dstIndex = size_t(w - 1 - x) * resW + y; break;
+                }
+                isExact = isExact && (result[dstIndex] == decoded[size_t(y) * w + x]);
+            }
+        }
+    }
+
+    // crop the center of the image and blit it back to the top-left corner of the empty image
+    const unsigned int cropX = (w / 4) & ~3u;
+    const unsigned int cropY = (h / 4) & ~3u;
+    const unsigned int cropW = (w / 2) & ~3u;
+    const unsigned int cropH = (h / 2) & ~3u;
+    std::vector<unsigned char> cropped(size_t(cropW / 4) * size_t(cropH / 4) * 8);
+    std::fill(transformed.begin(), transformed.end(), (unsigned char)0);
+    goofy::copyBlocks(cropped.data(), cropW, 0, 0, blocks.data(), w, cropX, cropY, cropW, cropH);
+    goofy::copyBlocks(transformed.data(), w, 0, 0, cropped.data(), cropW, 0, 0, cropW, cropH);
+    decompressFunc(transformed.data(), w, h, (unsigned char*)result.data(), size_t(w) * 4, 0);
+    for (unsigned int y = 0; y < cropH; y++)
+    {
+        for (unsigned int x = 0; x < cropW; x++)
+        {
+            isExact = isExact && (result[size_t(y) * w + x] == decoded[size_t(cropY + y) * w + cropX + x]);
+        }
+    }
+
+    const double numberOfPixels = double(w) * double(h);
+    printf("%s transforms (flip, rotate, crop, blit): %3.2f MP/s, exact: %s\n", format, numberOfPixels / bestTimeUs, isExact ? "yes" : "no");
+    return isExact;
+}
+
+// Compare ETC1s base color adjustment with the same adjustment of the decoded image
+// returns false if the identity adjustment is not lossless
+bool runTestAdjustColor(Timer& timer, unsigned int numberOfIterations, const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const size_t compressedSize = size_t(w / 4) * size_t(h / 4) * 8;
+    std::vector<unsigned char> blocks(compressedSize);
+    std::vector<unsigned char> adjusted(compressedSize);
+    std::vector<unsigned char> decoded(size_t(w) * h * 4);
+    std::vector<unsigned char> result(size_t(w) * h * 4);
+
+    goofy::compressETC1(blocks.data(), src, w, h, stride);
+
+    const unsigned int identityScale[3] = {256, 256, 256};
+    const int identityOffset[3] = {0, 0, 0};
+    goofy::adjustColorETC1s(adjusted.data(), blocks.data(), w, h, identityScale, identityOffset);
+    const bool isIdentical = (adjusted == blocks);
+
+    // warm orange tint
+    const unsigned int scale[3] = {320, 256, 192};
+    const int offset[3] = {-16, 8, 24};
+    double bestTimeUs = DBL_MAX;
+    for (unsigned int i = 0; i < numberOfIterations; i++)
+    {
+        timer.begin();
+        goofy::adjustColorETC1s(adjusted.data(), blocks.data(), w, h, scale, offset);
+        bestTimeUs = std::min(bestTimeUs, (double)timer.end());
+    }
+
+    DecoderBC::decompressETC1(blocks.data(), w, h, decoded.data(), size_t(w) * 4, 0);
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        const unsigned int ch = (unsigned int)(i & 3);
+        if (ch < 3)
+        {
+            const int v = int((decoded[i] * scale[ch]) >> 8) + offset[ch];
+            decoded[i] = (unsigned char)std::min(std::max(v, 0), 255);
+        }
+    }
+    DecoderBC::decompressETC1(adjusted.data(), w, h, result.data(), size_t(w) * 4, 0);
+    const MsePsnr msePsnr = getMsePsnr(decoded.data(), result.data(), w, h);
+
+    const double numberOfPixels = double(w) * double(h);
+    printf("ETC1 color adjustment: %3.2f MP/s, psnrRGB vs adjusted decode %3.5f, identity is lossless: %s\n", numberOfPixels / bestTimeUs, msePsnr.psnrRGB, isIdentical ? "yes" : "no");
+    return isIdentical;
+}
+
+typedef int (__cdecl* CompressWithStatsFunc_t)(unsigned char* dst, const unsigned char* src, unsigned int width, unsigned int height, unsigned int stride, goofy::EncoderStats* stats);
+
+static uint32_t getBrightness(const unsigned char* rgba)
+{
+    return (((uint32_t(rgba[0]) + uint32_t(rgba[2]) + 1) >> 1) + uint32_t(rgba[1]) + 1) >> 1;
+}
+
+// Compare encoder statistics with the statistics computed from the source pixels (must be exact) and print them
+// returns false if the blocks differ from the regular encoder or the statistics are not exact
+bool runTestEncoderStats(const char* format, CompressWithStatsFunc_t statsFunc, CompressFunc_t func, Timer& timer, unsigned int numberOfIterations, const unsigned char* src,
+                         unsigned int w, unsigned int h, unsigned int stride)
+{
+    const size_t compressedSize = size_t(w / 4) * size_t(h / 4) * 8;
+    std::vector<unsigned char> blocks(compressedSize);
+    std::vector<unsigned char> refBlocks(compressedSize);
+    func(refBlocks.data(), src, w, h, stride);
+
+    goofy::EncoderStats stats;
+    double bestTimeUs = DBL_MAX;
+    for (unsigned int i = 0; i < numberOfIterations; i++)
+    {
+        memset(&stats, 0, sizeof(stats));
+        timer.begin();
+        statsFunc(blocks.data(), src, w, h, stride, &stats);
+        bestTimeUs = std::min(bestTimeUs, (double)timer.end());
+    }
+
+    goofy::EncoderStats refStats;
+    memset(&refStats, 0, sizeof(refStats));
+    for (unsigned int by = 0; by < h / 4; by++)
+    {
+        for (unsigned int bx = 0; bx < w / 4; bx++)
+        {
+            unsigned char minColor[3] = {255, 255, 255};
+            unsigned char maxColor[3] = {0, 0, 0};
+            for (unsigned int i = 0; i < 16; i++)
+            {
+                const unsigned char* p = src + size_t(by * 4 + i / 4) * stride + (bx * 4 + i % 4) * 4;
+                for (int ch = 0; ch < 3; ch++)
+                {
+                    minColor[ch] = std::min(minColor[ch], p[ch]);
+                    maxColor[ch] = std::max(maxColor[ch], p[ch]);
+                }
+            }
+
+            const uint32_t minY = getBrightness(minColor);
+            const uint32_t maxY = getBrightness(maxColor);
+            const uint32_t midY = (minY + maxY + 1) >> 1;
+            refStats.numBlocks++;
+            refStats.numFlatBlocks += (memcmp(minColor, maxColor, 3) == 0) ? 1 : 0;
+            refStats.numRangeClampedBlocks += ((maxY - minY) < 8) ? 1 : 0;
+            for (unsigned int i = 0; i < 16; i++)
+            {
+                const uint32_t y = getBrightness(src + size_t(by * 4 + i / 4) * stride + (bx * 4 + i % 4) * 4);
+                refStats.numClampedPixels += ((y > midY ? y - midY : midY - y) > 127) ? 1 : 0;
+            }
+
+            if (strcmp(format, "ETC1") == 0)
+            {
+                const unsigned char* block = refBlocks.data() + (size_t(by) * (w / 4) + bx) * 8;
+                refStats.numEtcTableBlocks[block[3] >> 5]++;
+            }
+        }
+    }
+
+    const bool isSameBlocks = (blocks == refBlocks);
+    const bool isExact = (memcmp(&stats, &refStats, sizeof(stats)) == 0);
+    printf("%s encoder stats: %llu blocks, %llu flat, %llu range clamped, %llu clamped pixels, %3.2f MP/s, same blocks: %s, exact: %s\n", format,
+           (unsigned long long)stats.numBlocks, (unsigned long long)stats.numFlatBlocks, (unsigned long long)stats.numRangeClampedBlocks,
+           (unsigned long long)stats.numClampedPixels, double(w) * double(h) / bestTimeUs, isSameBlocks ? "yes" : "no", isExact ? "yes" : "no");
+    if (strcmp(format, "ETC1") == 0)
+    {
+        printf("ETC1 tables:");
+        for (int i = 0; i < 8; i++)
+        {
+            printf(" %llu", (unsigned long long)stats.numEtcTableBlocks[i]);
+        }
+        printf("\n");
+    }
+    return isSameBlocks && isExact;
+}
+
+typedef int (__cdecl* StatsFunc_t)(const unsigned char* input, unsigned int width, unsigned int height, goofy::ImageStats* stats, unsigned int tileSizeInBlocks, uint32_t* tileMinMax);
+
+// Compare compressed-domain statistics with the statistics of the decoded image (must be exact)
+// returns false if the statistics are not exact
+bool runTestStats(const char* format, StatsFunc_t statsFunc, CompressFunc_t func, DecompressFunc_t decompressFunc, Timer& timer, unsigned int numberOfIterations,
+                  const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    const unsigned int kTileSize = 8;
+    const unsigned int tilesW = (w / 4 + kTileSize - 1) / kTileSize;
+    const unsigned int tilesH = (h / 4 + kTileSize - 1) / kTileSize;
+    std::vector<unsigned char> blocks(size_t(w / 4) * size_t(h / 4) * 8);
+    std::vector<uint32_t> decoded(size_t(w) * h);
+    std::vector<uint32_t> tileMinMax(size_t(tilesW) * tilesH * 2);
+    func(blocks.data(), src, w, h, stride);
+
+    goofy::ImageStats stats;
+    double bestTimeUs = DBL_MAX;
+    double bestDecodeTimeUs = DBL_MAX;
+    for (unsigned int i = 0; i < numberOfIterations; i++)
+    {
+        timer.begin();
+        statsFunc(blocks.data(), w, h, &stats, kTileSize, tileMinMax.data());
+        bestTimeUs = std::min(bestTimeUs, (double)timer.end());
+
+        timer.begin();
+        decompressFunc(blocks.data(), w, h, (unsigned char*)decoded.data(), size_t(w) * 4, 1);
+        bestDecodeTimeUs = std::min(bestDecodeTimeUs, (double)timer.end());
+    }
+
+    uint64_t sum[3] = {0, 0, 0};
+    uint32_t histogram[16] = {0};
+    std::vector<uint32_t> refTileMinMax(tileMinMax.size());
+    for (size_t i = 0; i < refTileMinMax.size(); i += 2)
+    {
+        refTileMinMax[i] = 0xFFFFFF;
+        refTileMinMax[i + 1] = 0;
+    }
+    for (unsigned int y = 0; y < h; y++)
+    {
+        for (unsigned int x = 0; x < w; x++)
+        {
+            const uint32_t c = decoded[size_t(y) * w + x];
+            const uint32_t r = c & 0xFF;
+            const uint32_t g = (c >> 8) & 0xFF;
+            const uint32_t b = (c >> 16) & 0xFF;
+            sum[0] += r;
+            sum[1] += g;
+            sum[2] += b;
+            histogram[((((r + b + 1) >> 1) + g + 1) >> 1) >> 4]++;
+            uint32_t* tile = &refTileMinMax[(size_t(y / 4 / kTileSize) * tilesW + (x / 4 / kTileSize)) * 2];
+            for (uint32_t ch = 0; ch < 24; ch += 8)
+            {
+                const uint32_t mask = 0xFFu << ch;
+                tile[0] = ((c & mask) < (tile[0] & mask)) ? ((tile[0] & ~mask) | (c & mask)) : tile[0];
+                tile[1] = ((c & mask) > (tile[1] & mask)) ? ((tile[1] & ~mask) | (c & mask)) : tile[1];
+            }
+        }
+    }
+
+    bool isExact = (refTileMinMax == tileMinMax);
+    for (int i = 0; i < 3; i++)
+    {
+        isExact = isExact && (sum[i] == stats.sumRGB[i]);
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        isExact = isExact && (histogram[i] == stats.histogram[i]);
+    }
+
+    const double numberOfPixels = double(w) * double(h);
+    printf("%s stats: mean color (%3.1f, %3.1f, %3.1f), %3.2f MP/s (decode %3.2f MP/s), exact: %s\n", format, double(stats.sumRGB[0]) / numberOfPixels,
+           double(stats.sumRGB[1]) / numberOfPixels, double(stats.sumRGB[2]) / numberOfPixels, numberOfPixels / bestTimeUs, numberOfPixels / bestDecodeTimeUs,
+           isExact ? "yes" : "no");
+    return isExact;
+}
+
+// keeps the sampling loops from being optimized out
+static volatile float gSamplerSink = 0.0f;
+
+// Sample compressed texture with BlockSampler and compare with the decoded image
+// returns false if the texels are not exact or the bilinear samples do not match (up to float rounding)
+bool runTestSampler(const char* format, BlockSampler::Format samplerFormat, CompressFunc_t func, DecompressFunc_t decompressFunc, Timer& timer,
+                    const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    std::vector<unsigned char> blocks(size_t(w / 4) * size_t(h / 4) * 8);
+    std::vector<uint32_t> decoded(size_t(w) * h);
+    func(blocks.data(), src, w, h, stride);
+    decompressFunc(blocks.data(), w, h, (unsigned char*)decoded.data(), size_t(w) * 4, 0);
+
+    BlockSampler sampler;
+    sampler.setTexture(blocks.data(), w, h, samplerFormat);
+
+    // texel fetches must match the decoded image
+    bool isExact = true;
+    for (unsigned int y = 0; y < h; y++)
+    {
+        for (unsigned int x = 0; x < w; x++)
+        {
+            isExact = isExact && (sampler.fetch(int(x), int(y)) == decoded[size_t(y) * w + x]);
+        }
+    }
+
+    // coherent access: scanlines with sub-texel steps (e.g. light map baking)
+    // random access: pseudo random coordinates over the whole texture
+    const unsigned int kNumSamples = 1 << 20;
+    float maxError = 0.0f;
+    double timeUs[2] = {0.0, 0.0};
+    double hitRate[2] = {0.0, 0.0};
+    for (int mode = 0; mode < 2; mode++)
+    {
+        sampler.setTexture(blocks.data(), w, h, samplerFormat);
+        float sum = 0.0f;
+        uint32_t seed = 12345;
+        timer.begin();
+        for (unsigned int i = 0; i < kNumSamples; i++)
+        {
+            float u, v;
+            if (mode == 0)
+            {
+                const unsigned int row = i / (w * 3);
+                u = (float(i % (w * 3)) / 3.0f + 0.25f) / float(w);
+                v = (float(row % h) + 0.4f) / float(h);
+            }
+            else
+            {
+                seed = seed * 1664525u + 1013904223u;
+                u = float(seed >> 8) / float(1 << 24);
+                seed = seed * 1664525u + 1013904223u;
+                v = float(seed >> 8) / float(1 << 24);
+            }
+            float rgba[4];
+            sampler.sample(u, v, rgba);
+            sum += rgba[0];
+        }
+        timeUs[mode] = (double)timer.end();
+        hitRate[mode] = 1.0 - double(sampler.getNumMisses()) / double(std::max(sampler.getNumLookups(), uint64_t(1)));
+        gSamplerSink = sum;
+    }
+
+    // bilinear samples must match the filtering of the decoded image (edges clamped)
+    for (unsigned int i = 0; i < 4096; i++)
+    {
+        const float u = (float(i * 37 % 1009) / 1009.0f) * 1.02f - 0.01f;
+        const float v = (float(i * 61 % 997) / 997.0f) * 1.02f - 0.01f;
+        float rgba[4];
+        sampler.sample(u, v, rgba);
+
+        const float x = u * float(w) - 0.5f;
+        const float y = v * float(h) - 0.5f;
+        const int x0 = int(std::floor(x));
+        const int y0 = int(std::floor(y));
+        const float fx = x - std::floor(x);
+        const float fy = y - std::floor(y);
+        auto texel = [&](int tx, int ty, int ch) {
+            tx = std::min(std::max(tx, 0), int(w) - 1);
+            ty = std::min(std::max(ty, 0), int(h) - 1);
+            return float((decoded[size_t(ty) * w + tx] >> (ch * 8)) & 0xFF);
+        };
+        for (int ch = 0; ch < 4; ch++)
+        {
+            const float ref = texel(x0, y0, ch) * (1.0f - fx) * (1.0f - fy) + texel(x0 + 1, y0, ch) * fx * (1.0f - fy) + texel(x0, y0 + 1, ch) * (1.0f - fx) * fy +
+                              texel(x0 + 1, y0 + 1, ch) * fx * fy;
+            maxError = std::max(maxError, std::abs(ref - rgba[ch]));
+        }
+    }
+
+    printf("%s sampler: texels exact: %s, bilinear max error %1.5f, coherent %3.2f Msamples/s (block hit rate %2.2f%%), random %3.2f Msamples/s (block hit rate %2.2f%%)\n", format,
+           isExact ? "yes" : "no", maxError, double(kNumSamples) / timeUs[0], 100.0 * hitRate[0], double(kNumSamples) / timeUs[1], 100.0 * hitRate[1]);
+    return isExact && maxError < 0.01f;
+}
+
+// Build mip level 1 from Goofy blocks in the compressed domain and compare with decode + downsample + compress
+void runTestMip(const char* format, TranscodeFunc_t mipFunc, CompressFunc_t func, DecompressFunc_t decompressFunc, Timer& timer, unsigned int numberOfIterations,
+                const unsigned char* src, unsigned int w, unsigned int h, unsigned int stride)
+{
+    // level 1 must be a multiple of 16x4 to be compressed by Goofy
+    w = w & ~31u;
+    h = h & ~7u;
+    if (w == 0 || h == 0)
+    {
+        return;
+    }
+
+    const unsigned int mipW = w / 2;
+    const unsigned int mipH = h / 2;
+    std::vector<unsigned char> level0(size_t(w / 4) * size_t(h / 4) * 8);
+    std::vector<unsigned char> mipBlocks(size_t(mipW / 4) * size_t(mipH / 4) * 8);
+    std::vector<unsigned char> referenceBlocks(mipBlocks.size());
+    std::vector<unsigned char> decoded(size_t(w) * h * 4);
+    std::vector<unsigned char> downsampled(size_t(mipW) * mipH * 4);
+    std::vector<unsigned char> groundTruth(size_t(mipW) * mipH * 4);
+    std::vector<unsigned char> mipDecoded(size_t(mipW) * mipH * 4);
+
+    func(level0.data(), src, w, h, stride);
+    downsampleRgba8(groundTruth.data(), src, w, h, stride);
+
+    double bestMipTimeUs = DBL_MAX;
+    double bestReferenceTimeUs = DBL_MAX;
+    for (unsigned int i = 0; i < numberOfIterations; i++)
+    {
+        timer.begin();
+        mipFunc(mipBlocks.data(), level0.data(), w, h);
+        bestMipTimeUs = std::min(bestMipTimeUs, (double)timer.end());
+
+        timer.begin();
+        decompressFunc(level0.data(), w, h, decoded.data(), size_t(w) * 4, 1);
+        downsampleRgba8(downsampled.data(), decoded.data(), w, h, w * 4);
+        func(referenceBlocks.data(), downsampled.data(), mipW, mipH, mipW * 4);
+        bestReferenceTimeUs = std::min(bestReferenceTimeUs, (double)timer.end());
+    }
+
+    decompressFunc(mipBlocks.data(), mipW, mipH, mipDecoded.data(), size_t(mipW) * 4, 0);
+    const MsePsnr mipPsnr = getMsePsnr(groundTruth.data(), mipDecoded.data(), mipW, mipH);
+    decompressFunc(referenceBlocks.data(), mipW, mipH, mipDecoded.data(), size_t(mipW) * 4, 0);
+    const MsePsnr referencePsnr = getMsePsnr(groundTruth.data(), mipDecoded.data(), mipW, mipH);
+
+    // throughput in level 0 pixels
+    const double numberOfPixels = double(w) * double(h);
+    printf("%s mip %ux%u: compressed domain psnrRGB %3.5f, %3.2f MP/s (decode + downsample + compress psnrRGB %3.5f, %3.2f MP/s)\n", format, mipW, mipH,
+           mipPsnr.psnrRGB, numberOfPixels / bestMipTimeUs, referencePsnr.psnrRGB, numberOfPixels / bestReferenceTimeUs);
+}
+
+// Compare estimated per-block error (gErrorMap) with the actual brightness error of the decoded image
+void checkErrorMap(const char* encoderName, const char* format, const char* imageName, const unsigned char* src, const unsigned char* decoded, unsigned int w, unsigned int h)
+{
+    const unsigned int blockW = w / 4;
+    const unsigned int blockH = h / 4;
+    if (gErrorMap.size() != size_t(blockW) * size_t(blockH))
+    {
+        return;
+    }
+
+    // same brightness as the encoder uses: Y = (R + 2 * G + B) / 4
+    auto getY = [](const unsigned char* p) { return (double(p[0]) + 2.0 * double(p[1]) + double(p[2])) * 0.25; };
+
+    double sumEstimated = 0.0;
+    double sumActual = 0.0;
+    double sumEstimated2 = 0.0;
+    double sumActual2 = 0.0;
+    double sumEstimatedActual = 0.0;
+    std::vector<unsigned char> heatMap(size_t(blockW) * size_t(blockH) * 4);
+    for (unsigned int by = 0; by < blockH; by++)
+    {
+        for (unsigned int bx = 0; bx < blockW; bx++)
+        {
+            double actual = 0.0;
+            for (unsigned int y = 0; y < 4; y++)
+            {
+                for (unsigned int x = 0; x < 4; x++)
+                {
+                    size_t offset = (size_t(by * 4 + y) * w + (bx * 4 + x)) * 4;
+                    double d = getY(src + offset) - getY(decoded + offset);
+                    actual += d * d;
+                }
+            }
+
+            size_t blockIndex = size_t(by) * blockW + bx;
+            double estimated = double(gErrorMap[blockIndex]);
+            sumEstimated += estimated;
+            sumActual += actual;
+            sumEstimated2 += estimated * estimated;
+            sumActual2 += actual * actual;
+            sumEstimatedActual += estimated * actual;
+
+            // RMS brightness error per block, x8 for visibility
+            unsigned char v = (unsigned char)std::min(sqrt(estimated / 16.0) * 8.0, 255.0);
+            heatMap[blockIndex * 4 + 0] = v;
+            heatMap[blockIndex * 4 + 1] = v;
+            heatMap[blockIndex * 4 + 2] = v;
+            heatMap[blockIndex * 4 + 3] = 255;
+        }
+    }
+
+    const double n = double(blockW) * double(blockH);
+    const double covariance = sumEstimatedActual / n - (sumEstimated / n) * (sumActual / n);
+    const double varianceEstimated = sumEstimated2 / n - (sumEstimated / n) * (sumEstimated / n);
+    const double varianceActual = sumActual2 / n - (sumActual / n) * (sumActual / n);
+    const double correlation = (varianceEstimated > 0.0 && varianceActual > 0.0) ? covariance / sqrt(varianceEstimated * varianceActual) : 0.0;
+
+    const double numberOfPixels = double(w) * double(h);
+    const double psnrEstimated = getPSNR(sumEstimated / numberOfPixels, 255.0);
+    const double psnrActual = getPSNR(sumActual / numberOfPixels, 255.0);
+    printf("%s %s error map: estimated psnrY %3.5f, actual psnrY %3.5f, per-block correlation %1.3f\n", encoderName, format, psnrEstimated, psnrActual, correlation);
+
+    char fileName[256];
+    snprintf(fileName, sizeof(fileName), "./test-results/%s_%s_%s_errors.tga", imageName, encoderName, format);
+    saveTga(fileName, heatMap.data(), blockW, blockH);
+}
+
 // ============================================================================================
 
 bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>& results)
@@ -895,6 +2237,12 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
         std::cout << "Can't allocate memory for compressed buffer" << std::endl;
         return false;
     }
+
+    unsigned char* transcodeSourceBuffer = (unsigned char*)malloc(compressedBufferSizeInBytes);
+    if (transcodeSourceBuffer == nullptr) {
+        std::cout << "Can't allocate memory for transcode source buffer" << std::endl;
+        return false;
+    }
     saveTga(referenceFilename.c_str(), testImage, width, height);
 
     generateDownsamlpedRgb565Test(testImage, width, height, scratchBuffer);
@@ -905,6 +2253,7 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
     baselineRes.numberOfPixels = width * height;
     baselineRes.timeInMicroSeconds = 0;
     baselineRes.msePsnr = getMsePsnr(testImage, scratchBuffer, width, height);
+    baselineRes.ssim = Ssim::computeSsim(testImage, scratchBuffer, width, height);
     results.emplace_back(baselineRes);
     saveTga(baselineFilename.c_str(), scratchBuffer, width, height);
 
@@ -916,11 +2265,14 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
         res.numberOfPixels = width * height;
         res.timeInMicroSeconds = 0;
         res.msePsnr = getMsePsnr(testImage, basisImage, width, height);
+        res.ssim = Ssim::computeSsim(testImage, basisImage, width, height);
         results.emplace_back(res);
         saveTga(basisOutFilename.c_str(), scratchBuffer, width, height);
     }
 
     Timer timer;
+    // self-checks of the compressed-domain tools, a failed check fails the test (the results are still printed)
+    bool isPassed = true;
 
     res = runTestETC1("simd_goofy", imageName, goofy::compressETC1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
     results.emplace_back(res);
@@ -928,6 +2280,86 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
     res = runTestDXT1("simd_goofy", imageName, goofy::compressDXT1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
     results.emplace_back(res);
 
+    res = runTestETC1("simd_goofy_errmap", imageName, goofyCompressETC1WithErrorMap, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    checkErrorMap("simd_goofy", "ETC1", imageName, testImage, scratchBuffer, width, height);
+
+    res = runTestDXT1("simd_goofy_errmap", imageName, goofyCompressDXT1WithErrorMap, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    checkErrorMap("simd_goofy", "DXT1", imageName, testImage, scratchBuffer, width, height);
+
+    res = runTestDXT1("hybrid_goofy_ryg_10", imageName, hybridRygCompressDXT1<10>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+
+    res = runTestDXT1("hybrid_goofy_ryg_25", imageName, hybridRygCompressDXT1<25>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+
+    res = runTestDXT1("hybrid_goofy_icbc_10", imageName, hybridIcbcCompressDXT1<10>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+
+    res = runTestETC1("hybrid_goofy_rg_10", imageName, hybridRgCompressETC1<10>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+
+    res = runTestDXT1("simd_goofy_region", imageName, regionCompress<goofy::compressRegionDXT1>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    checkRegionEncode<goofy::compressRegionDXT1>("DXT1", goofy::compressDXT1, timer, testImage, width, height, stride);
+
+    res = runTestETC1("simd_goofy_region", imageName, regionCompress<goofy::compressRegionETC1>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    checkRegionEncode<goofy::compressRegionETC1>("ETC1", goofy::compressETC1, timer, testImage, width, height, stride);
+
+    gDedupCache = goofy::createBlockCache();
+    dedupCompress<goofy::compressDXT1Dedup>(compressedBuffer, testImage, width, height, stride);
+    printf("DXT1 dedup blocks from cache (not encoded), empty cache: %2.2f%%\n", getDedupHitRate());
+    res = runTestDXT1("simd_goofy_dedup", imageName, dedupCompress<goofy::compressDXT1Dedup>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    printf("DXT1 dedup blocks from cache (cache kept between calls): %2.2f%%\n", getDedupHitRate());
+    goofy::destroyBlockCache(gDedupCache);
+    gDedupCache = nullptr;
+    isPassed = runTestDedup("DXT1", dedupCompress<goofy::compressDXT1Dedup>, goofy::compressDXT1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    gDedupCache = goofy::createBlockCache();
+    dedupCompress<goofy::compressETC1Dedup>(compressedBuffer, testImage, width, height, stride);
+    printf("ETC1 dedup blocks from cache (not encoded), empty cache: %2.2f%%\n", getDedupHitRate());
+    res = runTestETC1("simd_goofy_dedup", imageName, dedupCompress<goofy::compressETC1Dedup>, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+    printf("ETC1 dedup blocks from cache (cache kept between calls): %2.2f%%\n", getDedupHitRate());
+    goofy::destroyBlockCache(gDedupCache);
+    gDedupCache = nullptr;
+    isPassed = runTestDedup("ETC1", dedupCompress<goofy::compressETC1Dedup>, goofy::compressETC1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    isPassed = runTestTemporal("DXT1", goofy::compressDXT1Temporal, goofy::compressDXT1, timer, testImage, width, height, stride) && isPassed;
+    isPassed = runTestTemporal("ETC1", goofy::compressETC1Temporal, goofy::compressETC1, timer, testImage, width, height, stride) && isPassed;
+
+    runTestMip("DXT1", goofy::generateMipDXT1, goofy::compressDXT1, DecoderBC::decompressDXT1, timer, kNumberOfIterations, testImage, width, height, stride);
+    runTestMip("ETC1", goofy::generateMipETC1s, goofy::compressETC1, DecoderBC::decompressETC1, timer, kNumberOfIterations, testImage, width, height, stride);
+
+    isPassed = runTestTransform("DXT1", goofy::transformDXT1, goofy::compressDXT1, DecoderBC::decompressDXT1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+    isPassed = runTestTransform("ETC1", goofy::transformETC1s, goofy::compressETC1, DecoderBC::decompressETC1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    isPassed = runTestAdjustColor(timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    isPassed = runTestSampler("DXT1", BlockSampler::FORMAT_DXT1, goofy::compressDXT1, DecoderBC::decompressDXT1, timer, testImage, width, height, stride) && isPassed;
+    isPassed = runTestSampler("ETC1", BlockSampler::FORMAT_ETC1, goofy::compressETC1, DecoderBC::decompressETC1, timer, testImage, width, height, stride) && isPassed;
+
+    isPassed = runTestStats("DXT1", goofy::getStatsDXT1, goofy::compressDXT1, DecoderBC::decompressDXT1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+    isPassed = runTestStats("ETC1", goofy::getStatsETC1s, goofy::compressETC1, DecoderBC::decompressETC1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    isPassed = runTestEncoderStats("DXT1", goofy::compressDXT1WithStats, goofy::compressDXT1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+    isPassed = runTestEncoderStats("ETC1", goofy::compressETC1WithStats, goofy::compressETC1, timer, kNumberOfIterations, testImage, width, height, stride) && isPassed;
+
+    res = runTestProgressive("progressive_goofy_ryg", "DXT1", imageName, goofy::compressDXT1, rygEncodeBlockDXT1, rygInitDXT1, nullptr, timer, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+    results.emplace_back(res);
+
+    {
+        rg_etc1::etc1_pack_params params;
+        params.clear();
+        params.m_quality = rg_etc1::cLowQuality;
+        params.m_dithering = false;
+        res = runTestProgressive("progressive_goofy_rg", "ETC1", imageName, goofy::compressETC1, rgEncodeBlockETC1, rgInitETC1, &params, timer, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
+        results.emplace_back(res);
+    }
+
     res = runTestDXT1("ref_goofy", imageName, goofyRef::compressDXT1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
     results.emplace_back(res);
 
@@ -946,6 +2378,56 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
     res = runTestETC1("rg", imageName, rgCompressETC1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, testImage, width, height, stride, scratchBuffer);
     results.emplace_back(res);
 
+    goofy::compressETC1(transcodeSourceBuffer, testImage, width, height, stride);
+    res = runTestTranscodeDXT1("simd_goofy_etc1s_to_dxt1", imageName, goofy::transcodeETC1sToDXT1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
+    rygCompressDXT1(transcodeSourceBuffer, testImage, width, height, stride);
+    res = runTestTranscodeETC1("simd_goofy_dxt1_to_etc1s", imageName, goofy::transcodeDXT1ToETC1s, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
+#ifdef _WIN32
+    gDecodeRgbaBuffer = (unsigned char*) _aligned_malloc(sizeInBytes, 64);
+#else
+    gDecodeRgbaBuffer = (unsigned char*) aligned_alloc(64, sizeInBytes);
+#endif
+    if (gDecodeRgbaBuffer != nullptr)
+    {
+        res = runTestTranscodeETC1("dxt1_decode_simd_goofy", imageName, decodeAndCompressETC1, timer, kNumberOfIterations, compressedBuffer, compressedBufferSizeInBytes, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+        results.emplace_back(res);
+#ifdef _WIN32
+        _aligned_free(gDecodeRgbaBuffer);
+#else
+        free(gDecodeRgbaBuffer);
+#endif
+        gDecodeRgbaBuffer = nullptr;
+    }
+
+    // decoders (ryg encoded DXT1/DXT5)
+    res = runTestDecode("squish_decoder", "DXT1", imageName, decompressDXT1Reference, timer, kNumberOfIterations, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
+    res = runTestDecode("simd_decoder", "DXT1", imageName, DecoderBC::decompressDXT1, timer, kNumberOfIterations, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
+    unsigned char* dxt5Buffer = (unsigned char*)malloc(compressedBufferSizeInBytes * 2);
+    if (dxt5Buffer != nullptr)
+    {
+        rygCompressDXT5(dxt5Buffer, testImage, width, height, stride);
+        res = runTestDecode("simd_decoder", "DXT5", imageName, DecoderBC::decompressDXT5, timer, kNumberOfIterations, dxt5Buffer, testImage, width, height, scratchBuffer);
+        results.emplace_back(res);
+        free(dxt5Buffer);
+    }
+
+    // ETC1s fast path (goofy encoded) and generic path (rg encoded)
+    goofy::compressETC1(transcodeSourceBuffer, testImage, width, height, stride);
+    res = runTestDecode("simd_decoder_etc1s", "ETC1", imageName, DecoderBC::decompressETC1, timer, kNumberOfIterations, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
+    rgCompressETC1(transcodeSourceBuffer, testImage, width, height, stride);
+    res = runTestDecode("simd_decoder", "ETC1", imageName, DecoderBC::decompressETC1, timer, kNumberOfIterations, transcodeSourceBuffer, testImage, width, height, scratchBuffer);
+    results.emplace_back(res);
+
     // print results
     char printBuffer[1024 * 10];
     for (const TestResult& r : results)
@@ -960,7 +2442,7 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
         double deltaPsnrRgb = r.msePsnr.psnrRGB - baselineRes.msePsnr.psnrRGB;
         double deltaPsnrY = r.msePsnr.psnrY - baselineRes.msePsnr.psnrY;
         sprintf(printBuffer,
-                "%s;%s;%s;%3.0f;%3.0f;%3.5f;%s;%3.5f;%3.5f;%3.5f\n",
+                "%s;%s;%s;%3.0f;%3.0f;%3.5f;%s;%3.5f;%3.5f;%3.5f;%1.5f;%1.5f\n",
                 imageName,
                 r.encoderName.c_str(),
                 r.format.c_str(),
@@ -970,21 +2452,427 @@ bool runTest(FILE* resultsFile, const char* imageName, std::vector<TestResult>&
                 formatResultsRGB(r.msePsnr).c_str(),
                 deltaPsnrMin,
                 deltaPsnrRgb,
-                deltaPsnrY);
+                deltaPsnrY,
+                r.ssim.ssim,
+                r.ssim.msSsim);
         std::cout << printBuffer << std::endl;
 
 #ifndef __EMSCRIPTEN__
-        fprintf(resultsFile, "%s;%s;%s;%3.0f;%3.0f;%3.5f;%s;%3.5f;%3.5f;%3.5f\n", imageName, r.encoderName.c_str(), r.format.c_str(), r.numberOfPixels, r.timeInMicroSeconds, mps, formatResultsRGB(r.msePsnr).c_str(), deltaPsnrMin, deltaPsnrRgb, deltaPsnrY);
+#ifdef ENABLE_PERF_COUNTERS
+        const std::string perfColumns = formatPerfCounters(r.perf);
+#else
+        const std::string perfColumns;
+#endif
+        fprintf(resultsFile, "%s;%s;%s;%3.0f;%3.0f;%3.5f;%s;%3.5f;%3.5f;%3.5f;%1.5f;%1.5f%s\n", imageName, r.encoderName.c_str(), r.format.c_str(), r.numberOfPixels, r.timeInMicroSeconds, mps, formatResultsRGB(r.msePsnr).c_str(), deltaPsnrMin, deltaPsnrRgb, deltaPsnrY, r.ssim.ssim, r.ssim.msSsim, perfColumns.c_str());
 #endif
     }
 
+    free(transcodeSourceBuffer);
     free(compressedBuffer);
     free(scratchBuffer);
     destroyPng(testImage);
     destroyPng(basisImage);
-    return true;
+    return isPassed;
+}
+
+// ============================================================================================
+
+#if (defined(ENABLE_SCALING_BENCHMARK) || defined(ENABLE_CACHE_SWEEP_BENCHMARK)) && !defined(__EMSCRIPTEN__)
+
+// Large image helpers (scaling and cache sweep benchmarks)
+static unsigned char* allocateImage(size_t sizeInBytes)
+{
+#ifdef _WIN32
+    return (unsigned char*)_aligned_malloc(sizeInBytes, 64);
+#else
+    return (unsigned char*)aligned_alloc(64, sizeInBytes);
+#endif
+}
+
+static void freeImage(unsigned char* image)
+{
+#ifdef _WIN32
+    _aligned_free(image);
+#else
+    free(image);
+#endif
+}
+
+// Synthetic content: smooth gradients, hard edges and noise
+static void generateSyntheticImage(unsigned char* dst, unsigned int w, unsigned int h)
+{
+    uint32_t seed = 0x2545F491;
+    for (unsigned int y = 0; y < h; y++)
+    {
+        unsigned char* p = dst + size_t(y) * w * 4;
+        for (unsigned int x = 0; x < w; x++, p += 4)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const uint32_t noise = (seed >> 24) & 15;
+            const bool isEdge = (((x >> 7) ^ (y >> 7)) & 1) != 0;
+            p[0] = (unsigned char)(((x * 255) / w) ^ (isEdge ? 0x80 : 0));
+            p[1] = (unsigned char)(((y * 255) / h) + noise);
+            p[2] = (unsigned char)(((x + y) >> 5) + noise);
+            p[3] = 255;
+        }
+    }
+}
+
+#endif
+
+#if defined(ENABLE_SCALING_BENCHMARK) && !defined(__EMSCRIPTEN__)
+
+// Thread scaling benchmark
+//
+// Large images are split into bands of block rows, every thread encodes one contiguous band (parallelFor).
+// All encoders are parallelized the same way, so they can be compared at equal core counts.
+static const unsigned int kScalingImageSizes[] = {8192, 16384};
+static const unsigned int kScalingIterations = 3;
+// stop repeating slow encoders after this time (the best time of the finished runs is used)
+static const double kScalingMaxTimeUs = 5000000.0;
+
+// Repeat (tile) the source image
+static void tileImage(unsigned char* dst, unsigned int w, unsigned int h, const unsigned char* src, unsigned int srcW, unsigned int srcH)
+{
+    for (unsigned int y = 0; y < h; y++)
+    {
+        const unsigned char* srcRow = src + size_t(y % srcH) * srcW * 4;
+        unsigned char* dstRow = dst + size_t(y) * w * 4;
+        for (unsigned int x = 0; x < w; x += srcW)
+        {
+            memcpy(dstRow + size_t(x) * 4, srcRow, size_t(std::min(srcW, w - x)) * 4);
+        }
+    }
+}
+
+// Third party encoders have global lookup tables: they are initialized once before the parallel runs,
+// the bands are encoded block by block (the image wrappers re-initialize the tables on every call)
+static void icbcInitDXT1()
+{
+    icbc::init_dxt1();
+}
+
+static void rgbcxInitDXT1()
+{
+    rgbcx::encode_bc1_init(false);
+}
+
+static void rgbcxEncodeBlockDXT1(unsigned char* result, const unsigned char* rgba, void* /*userData*/)
+{
+    rgbcx::encode_bc1(rgbcx::LEVEL0_OPTIONS, result, rgba, false, false);
+}
+
+// Encode block rows with a single block encoder
+static void encodeBlockRows(goofy::EncodeBlockFunc encodeBlock, void* userData, unsigned char* dst, const unsigned char* src, unsigned int w, size_t numBlockRows, size_t stride)
+{
+    unsigned char block[64];
+    for (size_t by = 0; by < numBlockRows; by++)
+    {
+        for (unsigned int x = 0; x < w; x += 4)
+        {
+            const unsigned char* p = src + by * 4 * stride + size_t(x) * 4;
+            memcpy(&block[0], p, 16);
+            memcpy(&block[16], p + stride, 16);
+            memcpy(&block[32], p + stride * 2, 16);
+            memcpy(&block[48], p + stride * 3, 16);
+            encodeBlock(dst, block, userData);
+            dst += 8;
+        }
+    }
+}
+
+// Best time of the parallel encode (us), image encoder (func) or block encoder (encodeBlock) is used
+double benchmarkParallelEncode(CompressFunc_t func, goofy::EncodeBlockFunc encodeBlock, void* userData, Timer& timer, unsigned int numThreads, unsigned char* dst,
+                               const unsigned char* src, unsigned int w, unsigned int h)
+{
+    const size_t stride = size_t(w) * 4;
+    const size_t dstPitch = size_t(w / 4) * 8;
+    double bestTimeUs = DBL_MAX;
+    double totalTimeUs = 0.0;
+    for (unsigned int iter = 0; iter < kScalingIterations && totalTimeUs < kScalingMaxTimeUs; iter++)
+    {
+        timer.begin();
+        parallelFor(h / 4, numThreads, [&](size_t begin, size_t end) {
+            if (func)
+            {
+                func(dst + begin * dstPitch, src + begin * 4 * stride, w, (unsigned int)(end - begin) * 4, (unsigned int)stride);
+            }
+            else
+            {
+                encodeBlockRows(encodeBlock, userData, dst + begin * dstPitch, src + begin * 4 * stride, w, end - begin, stride);
+            }
+        });
+        const double timeUs = double(timer.endNs()) / 1000.0;
+        bestTimeUs = std::min(bestTimeUs, timeUs);
+        totalTimeUs += timeUs;
+    }
+    return bestTimeUs;
+}
+
+void runScalingBenchmark(FILE* scalingFile, Timer& timer)
+{
+    // image encoder (func) or block encoder (init + encodeBlock)
+    struct ScalingEncoder
+    {
+        const char* name;
+        const char* format;
+        CompressFunc_t func;
+        void (*init)();
+        goofy::EncodeBlockFunc encodeBlock;
+        void* userData;
+    };
+
+    // same settings as rgCompressETC1
+    rg_etc1::etc1_pack_params rgParams;
+    rgParams.clear();
+    rgParams.m_quality = rg_etc1::cLowQuality;
+    rgParams.m_dithering = false;
+
+    const ScalingEncoder encoders[] = {
+        {"simd_goofy", "DXT1", goofy::compressDXT1, nullptr, nullptr, nullptr},
+        {"simd_goofy", "ETC1", goofy::compressETC1, nullptr, nullptr, nullptr},
+        {"ryg", "DXT1", nullptr, rygInitDXT1, rygEncodeBlockDXT1, nullptr},
+        {"icbc", "DXT1", nullptr, icbcInitDXT1, icbcEncodeBlockDXT1, nullptr},
+        {"rgbcx", "DXT1", nullptr, rgbcxInitDXT1, rgbcxEncodeBlockDXT1, nullptr},
+        {"rg", "ETC1", nullptr, rgInitETC1, rgEncodeBlockETC1, &rgParams},
+    };
+
+    // 1, 2, 4, ... and all hardware threads
+    std::vector<unsigned int> threadCounts;
+    const unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned int n = 1; n < maxThreads; n *= 2)
+    {
+        threadCounts.push_back(n);
+    }
+    threadCounts.push_back(maxThreads);
+
+    unsigned int realWidth = 0;
+    unsigned int realHeight = 0;
+    unsigned char* realImage = loadPngAsRgba8("test-data/parrot_red.png", &realWidth, &realHeight);
+
+    std::cout << "---[ Thread scaling ]-------------\n";
+    std::cout << "Image;Encoder;Format;Threads;time (us);MP/s;speedup;efficiency" << std::endl;
+    fprintf(scalingFile, "Image;Encoder;Format;Threads;time (us);MP/s;speedup;efficiency\n");
+
+    for (unsigned int size : kScalingImageSizes)
+    {
+        for (int isSynthetic = 0; isSynthetic < 2; isSynthetic++)
+        {
+            if (!isSynthetic && realImage == nullptr)
+            {
+                continue;
+            }
+
+            unsigned char* image = allocateImage(size_t(size) * size * 4);
+            unsigned char* compressed = allocateImage(size_t(size) * size / 2);
+            if (image == nullptr || compressed == nullptr)
+            {
+                printf("Can't allocate memory for %u x %u image, skipped\n", size, size);
+                freeImage(image);
+                freeImage(compressed);
+                continue;
+            }
+
+            char imageName[64];
+            snprintf(imageName, sizeof(imageName), "%s_%uk", isSynthetic ? "synthetic" : "parrot_red", size / 1024);
+            if (isSynthetic)
+            {
+                generateSyntheticImage(image, size, size);
+            }
+            else
+            {
+                tileImage(image, size, size, realImage, realWidth, realHeight);
+            }
+
+            const double numberOfPixels = double(size) * double(size);
+            for (const ScalingEncoder& encoder : encoders)
+            {
+                if (encoder.init)
+                {
+                    encoder.init();
+                }
+
+                double singleThreadTimeUs = 0.0;
+                for (unsigned int numThreads : threadCounts)
+                {
+                    const double timeUs = benchmarkParallelEncode(encoder.func, encoder.encodeBlock, encoder.userData, timer, numThreads, compressed, image, size, size);
+                    if (numThreads == 1)
+                    {
+                        singleThreadTimeUs = timeUs;
+                    }
+                    const double mps = numberOfPixels / timeUs;
+                    const double speedup = singleThreadTimeUs / timeUs;
+                    const double efficiency = speedup / double(numThreads);
+                    printf("%s;%s;%s;%u;%.0f;%3.2f;%1.2f;%1.2f\n", imageName, encoder.name, encoder.format, numThreads, timeUs, mps, speedup, efficiency);
+                    fprintf(scalingFile, "%s;%s;%s;%u;%.0f;%3.2f;%1.2f;%1.2f\n", imageName, encoder.name, encoder.format, numThreads, timeUs, mps, speedup, efficiency);
+                }
+            }
+
+            freeImage(image);
+            freeImage(compressed);
+        }
+    }
+
+    destroyPng(realImage);
+}
+#endif
+
+#if defined(ENABLE_CACHE_SWEEP_BENCHMARK) && !defined(__EMSCRIPTEN__)
+
+// Cache hierarchy sweep
+//
+// Input sizes from 16 KB (L1) to GBs (DRAM), every size is encoded in two modes
+//   warm - the same input is encoded again and again (it stays in the caches if it fits)
+//   cold - input and output are evicted from all cache levels before every run
+static const size_t kCacheSweepMinBytes = 16 * 1024;
+static const size_t kCacheSweepMaxBytes = size_t(2) * 1024 * 1024 * 1024;
+// every warm sample encodes at least this amount of input (tiny sizes are too fast for the timer)
+static const size_t kCacheSweepMinSampleBytes = 1024 * 1024;
+static const unsigned int kCacheSweepSamples = 15;
+static const unsigned int kCacheSweepLargeSamples = 3;
+static const size_t kCacheSweepLargeBytes = 256 * 1024 * 1024;
+// the sweep never uses more than this fraction of the physical memory (allocations can succeed because of overcommit and get OOM-killed on first touch)
+static const size_t kCacheSweepPhysicalMemoryFraction = 4;
+// bound used when the physical memory size is unknown
+static const size_t kCacheSweepFallbackMaxBytes = 512 * 1024 * 1024;
+
+// Returns physical memory size in bytes (0 if unknown)
+size_t getPhysicalMemoryBytes()
+{
+#if !defined(_WIN32) && defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    const long numPages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (numPages > 0 && pageSize > 0)
+    {
+        return size_t(numPages) * size_t(pageSize);
+    }
+#endif
+    return 0;
+}
+
+// Evict memory range from all cache levels
+void evictFromCache(const unsigned char* data, size_t sizeInBytes)
+{
+#ifdef GOOFY_SSE2
+    for (size_t i = 0; i < sizeInBytes; i += 64)
+    {
+        _mm_clflush(data + i);
+    }
+    _mm_mfence();
+#else
+    // no cache control instructions: touch a buffer larger than the last level cache instead
+    static std::vector<unsigned char> evictionBuffer(size_t(256) * 1024 * 1024);
+    for (size_t i = 0; i < evictionBuffer.size(); i += 64)
+    {
+        evictionBuffer[i]++;
+    }
+    (void)data;
+    (void)sizeInBytes;
+#endif
 }
 
+void runCacheSweepBenchmark(FILE* sweepFile, Timer& timer)
+{
+    struct SweepEncoder
+    {
+        const char* format;
+        CompressFunc_t func;
+    };
+
+    const SweepEncoder encoders[] = {
+        {"DXT1", goofy::compressDXT1},
+        {"ETC1", goofy::compressETC1},
+    };
+
+    // sizes that do not fit into the physical memory are skipped
+    const size_t physicalMemoryBytes = getPhysicalMemoryBytes();
+    const size_t memoryLimitBytes = (physicalMemoryBytes != 0) ? (physicalMemoryBytes / kCacheSweepPhysicalMemoryFraction) : kCacheSweepFallbackMaxBytes;
+    size_t maxBytes = kCacheSweepMaxBytes;
+    while (maxBytes > kCacheSweepMinBytes && maxBytes + maxBytes / 8 > memoryLimitBytes)
+    {
+        maxBytes /= 2;
+    }
+    if (maxBytes < kCacheSweepMaxBytes)
+    {
+        printf("Cache sweep is limited to %.0f KB by the memory size\n", double(maxBytes) / 1024.0);
+    }
+
+    // allocate the largest buffer possible (up to maxBytes), smaller sizes use the beginning of the buffer
+    unsigned char* image = nullptr;
+    unsigned char* compressed = nullptr;
+    while (maxBytes >= kCacheSweepMinBytes)
+    {
+        image = allocateImage(maxBytes);
+        compressed = allocateImage(maxBytes / 8);
+        if (image != nullptr && compressed != nullptr)
+        {
+            break;
+        }
+        freeImage(image);
+        freeImage(compressed);
+        image = nullptr;
+        compressed = nullptr;
+        maxBytes /= 2;
+    }
+
+    if (image == nullptr)
+    {
+        printf("Can't allocate memory for the cache sweep\n");
+        return;
+    }
+
+    // 4096 pixels wide (16 KB rows), smaller images are 16 pixels high
+    generateSyntheticImage(image, 4096, (unsigned int)(maxBytes / (4096 * 4)));
+
+    std::cout << "---[ Cache sweep ]-------------\n";
+    std::cout << "Size (KB);Mode;Format;Width;Height;time (us);MP/s;GB/s" << std::endl;
+    fprintf(sweepFile, "Size (KB);Mode;Format;Width;Height;time (us);MP/s;GB/s\n");
+
+    for (size_t sizeInBytes = kCacheSweepMinBytes; sizeInBytes <= maxBytes; sizeInBytes *= 2)
+    {
+        const size_t numberOfPixels = sizeInBytes / 4;
+        const unsigned int w = (unsigned int)std::min(size_t(4096), numberOfPixels / 16);
+        const unsigned int h = (unsigned int)(numberOfPixels / w);
+        const unsigned int numberOfSamples = (sizeInBytes >= kCacheSweepLargeBytes) ? kCacheSweepLargeSamples : kCacheSweepSamples;
+
+        for (const SweepEncoder& encoder : encoders)
+        {
+            for (int isCold = 0; isCold < 2; isCold++)
+            {
+                const unsigned int numberOfRepeats = isCold ? 1 : (unsigned int)std::max(size_t(1), kCacheSweepMinSampleBytes / sizeInBytes);
+                std::vector<double> samplesNs;
+                encoder.func(compressed, image, w, h, w * 4);
+                for (unsigned int sample = 0; sample < numberOfSamples; sample++)
+                {
+                    if (isCold)
+                    {
+                        evictFromCache(image, sizeInBytes);
+                        evictFromCache(compressed, sizeInBytes / 8);
+                    }
+
+                    timer.begin();
+                    for (unsigned int i = 0; i < numberOfRepeats; i++)
+                    {
+                        encoder.func(compressed, image, w, h, w * 4);
+                    }
+                    samplesNs.push_back(double(timer.endNs()) / double(numberOfRepeats));
+                }
+
+                const BenchmarkStats stats = computeBenchmarkStats(samplesNs);
+                const double timeUs = stats.medianNs / 1000.0;
+                const double mps = double(numberOfPixels) / timeUs;
+                const double gbs = double(sizeInBytes) / stats.medianNs;
+                const char* mode = isCold ? "cold" : "warm";
+                printf("%.0f;%s;%s;%u;%u;%.1f;%3.2f;%2.3f\n", double(sizeInBytes) / 1024.0, mode, encoder.format, w, h, timeUs, mps, gbs);
+                fprintf(sweepFile, "%.0f;%s;%s;%u;%u;%.1f;%3.2f;%2.3f\n", double(sizeInBytes) / 1024.0, mode, encoder.format, w, h, timeUs, mps, gbs);
+            }
+        }
+    }
+
+    freeImage(image);
+    freeImage(compressed);
+}
+#endif
 
 #define ARRAY_SIZE(v) (sizeof(v) / sizeof(v[0]))
 
@@ -1055,6 +2943,24 @@ int main()
         printf("Can't create file './test-results/sumary.txt'\n");
         return -3;
     }
+
+#if defined(ENABLE_ROBUST_BENCHMARK) && !defined(__EMSCRIPTEN__)
+    FILE* benchmarkFile = fopen("./test-results/benchmark.json", "w");
+    if (!benchmarkFile)
+    {
+        printf("Can't create file './test-results/benchmark.json'\n");
+        return -4;
+    }
+    fprintf(benchmarkFile, "[");
+    bool isFirstBenchmark = true;
+#endif
+
+#ifdef BENCHMARK_PIN_THREAD
+    if (!pinCurrentThread())
+    {
+        printf("Can't pin benchmark thread to the first core\n");
+    }
+#endif
 #else
 
 TEST_CASE("main")
@@ -1070,6 +2976,8 @@ TEST_CASE("main")
         double psnrMinSum = 0.0;
         double psnrRGBSum = 0.0;
         double psnrYSum = 0.0;
+        double ssimSum = 0.0;
+        double msSsimSum = 0.0;
         double numberOfImages = 0.0;
         double time = 0.0;
     };
@@ -1078,11 +2986,15 @@ TEST_CASE("main")
 
     std::cout << "Image;Encoder;Format;NumberOfPixels;time "
                  "(us);MP/s;mseR;mseG;mseB;mseMax;mseRGB;mseY;psnrR (db);psnrG (db);psnrB "
-                 "(db);psnrMin (db);psnrRGB (db);psnrY (db);deltaMin (db);deltaRGB (db);deltaY (db)"
+                 "(db);psnrMin (db);psnrRGB (db);psnrY (db);deltaMin (db);deltaRGB (db);deltaY (db);ssim;msSsim"
               << std::endl;
 #ifndef __EMSCRIPTEN__
-    fprintf(resultsFile, "Image;Encoder;Format;NumberOfPixels;time (us);MP/s;mseR;mseG;mseB;mseMax;mseRGB;mseY;psnrR (db);psnrG (db);psnrB (db);psnrMin (db);psnrRGB (db);psnrY (db);deltaMin (db);deltaRGB (db);deltaY (db)\n");
-    fprintf(summaryFile, "Codec;Format;Avg psnrMin (db);Avg psnrRGB (db); Avg psnrY (db); Number of tests; Avg time (msec)\n");
+    fprintf(resultsFile, "Image;Encoder;Format;NumberOfPixels;time (us);MP/s;mseR;mseG;mseB;mseMax;mseRGB;mseY;psnrR (db);psnrG (db);psnrB (db);psnrMin (db);psnrRGB (db);psnrY (db);deltaMin (db);deltaRGB (db);deltaY (db);ssim;msSsim");
+#ifdef ENABLE_PERF_COUNTERS
+    fprintf(resultsFile, ";IPC;cycles/block;L1D misses/block;LLC misses/block;branch misses/block");
+#endif
+    fprintf(resultsFile, "\n");
+    fprintf(summaryFile, "Codec;Format;Avg psnrMin (db);Avg psnrRGB (db); Avg psnrY (db); Avg ssim; Avg msSsim; Number of tests; Avg time (msec)\n");
 #endif
     for(unsigned int i = 0; i < ARRAY_SIZE(testImages); i++)
     {
@@ -1097,6 +3009,23 @@ TEST_CASE("main")
 #endif
         }
 
+#if defined(ENABLE_ROBUST_BENCHMARK) && !defined(__EMSCRIPTEN__)
+        for (const TestResult& r : results)
+        {
+            if (r.timing.numberOfSamples == 0)
+            {
+                continue;
+            }
+            fprintf(benchmarkFile,
+                    "%s\n  {\"image\": \"%s\", \"encoder\": \"%s\", \"format\": \"%s\", \"pixels\": %.0f, \"warmup\": %d, \"iterations\": %u, "
+                    "\"min_ns\": %.0f, \"median_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, \"mad_ns\": %.0f, \"median_mps\": %.3f}",
+                    isFirstBenchmark ? "" : ",", testImages[i], r.encoderName.c_str(), r.format.c_str(), r.numberOfPixels, kNumberOfWarmupIterations,
+                    r.timing.numberOfSamples, r.timing.minNs, r.timing.medianNs, r.timing.p90Ns, r.timing.p99Ns, r.timing.madNs,
+                    r.numberOfPixels * 1000.0 / r.timing.medianNs);
+            isFirstBenchmark = false;
+        }
+#endif
+
         for (const TestResult& r : results)
         {
             tmp = r.encoderName + ";" + r.format;
@@ -1104,13 +3033,43 @@ TEST_CASE("main")
             codecAvg.psnrMinSum += r.msePsnr.psnrMin;
             codecAvg.psnrRGBSum += r.msePsnr.psnrRGB;
             codecAvg.psnrYSum += r.msePsnr.psnrY;
+            codecAvg.ssimSum += r.ssim.ssim;
+            codecAvg.msSsimSum += r.ssim.msSsim;
             codecAvg.time += r.timeInMicroSeconds;
             codecAvg.numberOfImages += 1.0;
         }
     }
 
+#if defined(ENABLE_SCALING_BENCHMARK) && !defined(__EMSCRIPTEN__)
+    FILE* scalingFile = fopen("./test-results/scaling.txt", "w");
+    if (scalingFile)
+    {
+        Timer scalingTimer;
+        runScalingBenchmark(scalingFile, scalingTimer);
+        fclose(scalingFile);
+    }
+    else
+    {
+        printf("Can't create file './test-results/scaling.txt'\n");
+    }
+#endif
+
+#if defined(ENABLE_CACHE_SWEEP_BENCHMARK) && !defined(__EMSCRIPTEN__)
+    FILE* sweepFile = fopen("./test-results/cache_sweep.txt", "w");
+    if (sweepFile)
+    {
+        Timer sweepTimer;
+        runCacheSweepBenchmark(sweepFile, sweepTimer);
+        fclose(sweepFile);
+    }
+    else
+    {
+        printf("Can't create file './test-results/cache_sweep.txt'\n");
+    }
+#endif
+
     std::cout << "---[ Summary ]-------------\n";
-    std::cout << "Codec;Format                      Avg:     psnrMin   psnrRGB     psnrY   N tests "
+    std::cout << "Codec;Format                      Avg:     psnrMin   psnrRGB     psnrY     ssim    msSsim   N tests "
                  "  time (msec)\n";
 
     char printBuffer[1024 * 10];
@@ -1121,7 +3080,9 @@ TEST_CASE("main")
         double psnrRGBAvg = avg.second.psnrRGBSum / avg.second.numberOfImages;
         tmp += psnrToString(psnrRGBAvg) + "  ";
         double psnrYAvg = avg.second.psnrYSum / avg.second.numberOfImages;
-        tmp += psnrToString(psnrYAvg);
+        tmp += psnrToString(psnrYAvg) + "  ";
+        sprintf(printBuffer, "%1.5f  %1.5f", avg.second.ssimSum / avg.second.numberOfImages, avg.second.msSsimSum / avg.second.numberOfImages);
+        tmp += printBuffer;
         double timeAvg = avg.second.time / (avg.second.numberOfImages * 1000);
         sprintf(printBuffer,
                 "%-40s  %s         %.0f        %5.1f\n",
@@ -1139,6 +3100,10 @@ TEST_CASE("main")
 #ifndef __EMSCRIPTEN__
     fclose(summaryFile);
     fclose(resultsFile);
+#endif
+#if defined(ENABLE_ROBUST_BENCHMARK) && !defined(__EMSCRIPTEN__)
+    fprintf(benchmarkFile, "\n]\n");
+    fclose(benchmarkFile);
 #endif
     std::cout << "Finished. Check './test-results/results.txt' for details" << std::endl;
 #ifndef __EMSCRIPTEN__
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Split [0, count) range into numThreads contiguous chunks and call func(begin, end) for each chunk in parallel
+// numThreads = 0 means use all hardware threads
+template <typename Func> void parallelFor(size_t count, unsigned int numThreads, const Func& func)
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    // single threaded wasm build
+    numThreads = 1;
+#else
+    if (numThreads == 0)
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+#endif
+
+    if (numThreads > count)
+    {
+        numThreads = (unsigned int)count;
+    }
+
+    if (numThreads <= 1)
+    {
+        func(size_t(0), count);
+        return;
+    }
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    size_t chunkSize = count / numThreads;
+    size_t remainder = count % numThreads;
+    size_t begin = 0;
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        size_t end = begin + chunkSize + ((i < remainder) ? 1 : 0);
+        if (i == (numThreads - 1))
+        {
+            // the last chunk is processed on the calling thread
+            func(begin, end);
+        }
+        else
+        {
+            threads.emplace_back([&func, begin, end]() { func(begin, end); });
+        }
+        begin = end;
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+#endif
+}
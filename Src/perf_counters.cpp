@@ -0,0 +1,107 @@
+#include "perf_counters.h"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int openPerfEvent(uint32_t type, uint64_t config, int groupFd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    // the group leader starts disabled, members follow the leader
+    attr.disabled = (groupFd < 0) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+PerfCounters::PerfCounters()
+{
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        fds[i] = -1;
+    }
+
+    // all counters are in one group (scheduled on the PMU together)
+    fds[COUNTER_CYCLES] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (fds[COUNTER_CYCLES] < 0)
+    {
+        return;
+    }
+
+    const int leader = fds[COUNTER_CYCLES];
+    fds[COUNTER_INSTRUCTIONS] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+    fds[COUNTER_L1D_MISSES] = openPerfEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), leader);
+    fds[COUNTER_LLC_MISSES] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, leader);
+    fds[COUNTER_BRANCH_MISSES] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        if (fds[i] >= 0)
+        {
+            close(fds[i]);
+        }
+    }
+}
+
+void PerfCounters::reset()
+{
+    if (isAvailable())
+    {
+        ioctl(fds[COUNTER_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void PerfCounters::start()
+{
+    if (isAvailable())
+    {
+        ioctl(fds[COUNTER_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void PerfCounters::stop()
+{
+    if (isAvailable())
+    {
+        ioctl(fds[COUNTER_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+uint64_t PerfCounters::getValue(Counter counter) const
+{
+    uint64_t value = 0;
+    if (fds[counter] < 0 || read(fds[counter], &value, sizeof(value)) != (ssize_t)sizeof(value))
+    {
+        return 0;
+    }
+    return value;
+}
+
+#else
+
+// not supported
+PerfCounters::PerfCounters()
+{
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        fds[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {}
+void PerfCounters::reset() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+uint64_t PerfCounters::getValue(Counter) const { return 0; }
+
+#endif
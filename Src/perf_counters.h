@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Hardware performance counters of the calling thread (Linux perf_event_open), used around encoder calls
+//
+// Counters are not available on other platforms, in most containers/VMs or with kernel.perf_event_paranoid > 2:
+// isAvailable() returns false in this case and all values are zero. Single counters can be missing as well
+// (e.g. no LLC events on some virtual PMUs), use isCounterAvailable() to check.
+class PerfCounters
+{
+  public:
+    enum Counter
+    {
+        COUNTER_CYCLES,
+        COUNTER_INSTRUCTIONS,
+        COUNTER_L1D_MISSES,
+        COUNTER_LLC_MISSES,
+        COUNTER_BRANCH_MISSES,
+        COUNTER_COUNT
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool isAvailable() const { return fds[COUNTER_CYCLES] >= 0; }
+    bool isCounterAvailable(Counter counter) const { return fds[counter] >= 0; }
+
+    // Counting is accumulated between start/stop pairs until reset
+    void reset();
+    void start();
+    void stop();
+
+    uint64_t getValue(Counter counter) const;
+
+  private:
+    int fds[COUNTER_COUNT];
+};
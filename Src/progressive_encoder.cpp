@@ -0,0 +1,179 @@
+#include "progressive_encoder.h"
+#include <algorithm>
+#include <cstring>
+
+ProgressiveEncoder::ProgressiveEncoder(unsigned int tileSizeInBlocks, unsigned int _numThreads)
+    : tileSize(std::max(tileSizeInBlocks, 1u))
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    // single threaded wasm build (refinement is done synchronously inside start)
+    , numThreads(0)
+#else
+    , numThreads((_numThreads != 0) ? _numThreads : std::max(std::thread::hardware_concurrency(), 1u))
+#endif
+    , nextTile(0)
+    , numRefinedTiles(0)
+    , cancelled(false)
+{
+}
+
+ProgressiveEncoder::~ProgressiveEncoder() { cancel(); }
+
+int ProgressiveEncoder::start(const unsigned char* rgba, unsigned int _width, unsigned int _height, unsigned int _stride, CompressFunc fastEncoder,
+                              EncodeBlockFunc slowEncoder, void* userData)
+{
+    cancel();
+
+    const unsigned int _blocksW = _width / 4;
+    const unsigned int _blocksH = _height / 4;
+    std::vector<unsigned char> fastBlocks(size_t(_blocksW) * size_t(_blocksH) * 8);
+    int res = fastEncoder(fastBlocks.data(), rgba, _width, _height, _stride);
+    if (res != 0)
+    {
+        return res;
+    }
+
+    source = rgba;
+    width = _width;
+    height = _height;
+    stride = _stride;
+    encodeBlock = slowEncoder;
+    encodeBlockUserData = userData;
+    blocksW = _blocksW;
+    blocksH = _blocksH;
+    tilesW = (blocksW + tileSize - 1) / tileSize;
+    tilesH = (blocksH + tileSize - 1) / tileSize;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.swap(fastBlocks);
+        dirtyTiles.clear();
+        version++;
+        dirtyTiles.push_back(Tile{0, 0, blocksW, blocksH, version});
+    }
+
+    nextTile = 0;
+    numRefinedTiles = 0;
+    cancelled = false;
+
+    if (numThreads == 0)
+    {
+        refineTiles();
+        return 0;
+    }
+
+    workers.reserve(numThreads);
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        workers.emplace_back([this]() { refineTiles(); });
+    }
+    return 0;
+}
+
+void ProgressiveEncoder::cancel()
+{
+    cancelled = true;
+    wait();
+}
+
+void ProgressiveEncoder::wait()
+{
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+}
+
+bool ProgressiveEncoder::isFinished() const { return numRefinedTiles == (tilesW * tilesH); }
+
+uint64_t ProgressiveEncoder::getVersion() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return version;
+}
+
+uint64_t ProgressiveEncoder::getDirtyTiles(uint64_t sinceVersion, std::vector<Tile>& tiles) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // tiles are sorted by version
+    auto it = std::upper_bound(dirtyTiles.begin(), dirtyTiles.end(), sinceVersion, [](uint64_t v, const Tile& tile) { return v < tile.version; });
+    tiles.insert(tiles.end(), it, dirtyTiles.end());
+    return version;
+}
+
+void ProgressiveEncoder::copyTile(const Tile& tile, unsigned char* dst, size_t dstPitch) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned int y = 0; y < tile.height; y++)
+    {
+        memcpy(dst + y * dstPitch, blocks.data() + (size_t(tile.y + y) * blocksW + tile.x) * 8, size_t(tile.width) * 8);
+    }
+}
+
+void ProgressiveEncoder::copyBlocks(unsigned char* dst) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    memcpy(dst, blocks.data(), blocks.size());
+}
+
+void ProgressiveEncoder::refineTiles()
+{
+    std::vector<unsigned char> tileBlocks(size_t(tileSize) * size_t(tileSize) * 8);
+    const unsigned int numTiles = tilesW * tilesH;
+    while (!cancelled)
+    {
+        unsigned int tileIndex = nextTile++;
+        if (tileIndex >= numTiles)
+        {
+            break;
+        }
+        refineTile(tileIndex, tileBlocks);
+    }
+}
+
+void ProgressiveEncoder::refineTile(unsigned int tileIndex, std::vector<unsigned char>& tileBlocks)
+{
+    Tile tile;
+    tile.x = (tileIndex % tilesW) * tileSize;
+    tile.y = (tileIndex / tilesW) * tileSize;
+    tile.width = std::min(tileSize, blocksW - tile.x);
+    tile.height = std::min(tileSize, blocksH - tile.y);
+    tile.version = 0;
+
+    // encode without holding the lock
+    unsigned char block[64];
+    unsigned char* result = tileBlocks.data();
+    for (unsigned int by = 0; by < tile.height; by++)
+    {
+        for (unsigned int bx = 0; bx < tile.width; bx++)
+        {
+            const unsigned char* p = source + size_t(tile.y + by) * 4 * stride + size_t(tile.x + bx) * 16;
+            memcpy(&block[0], p, 16);
+            memcpy(&block[16], p + stride, 16);
+            memcpy(&block[32], p + stride * 2, 16);
+            memcpy(&block[48], p + stride * 3, 16);
+            encodeBlock(result, block, encodeBlockUserData);
+            result += 8;
+        }
+    }
+
+    if (cancelled)
+    {
+        return;
+    }
+
+    publishTile(tile, tileBlocks.data());
+    numRefinedTiles++;
+}
+
+void ProgressiveEncoder::publishTile(const Tile& tile, const unsigned char* tileBlocks)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned int y = 0; y < tile.height; y++)
+    {
+        memcpy(blocks.data() + (size_t(tile.y + y) * blocksW + tile.x) * 8, tileBlocks + size_t(y) * tile.width * 8, size_t(tile.width) * 8);
+    }
+    version++;
+    dirtyTiles.push_back(Tile{tile.x, tile.y, tile.width, tile.height, version});
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Progressive texture encoder (live texture sync)
+//
+// The texture is encoded synchronously with a fast encoder (e.g. Goofy) and then refined tile by tile in background
+// threads with a slow high quality block encoder. Every refined tile is published with a new version number,
+// so the client can upload only changed tiles to the GPU.
+//
+// Usage:
+//   encoder.start(...);                                  // the fast result is ready here
+//   version = encoder.getDirtyTiles(version, tiles);     // poll (e.g. once per frame)
+//   encoder.copyTile(tile, ...);                         // upload changed tiles
+class ProgressiveEncoder
+{
+  public:
+    typedef int (*CompressFunc)(unsigned char* dst, const unsigned char* src, unsigned int width, unsigned int height, unsigned int stride);
+
+    // Encode 4x4 RGBA block (16 bytes per line) to 8 bytes
+    typedef void (*EncodeBlockFunc)(unsigned char* result, const unsigned char* rgba, void* userData);
+
+    // Rectangle of blocks (in blocks, not pixels)
+    struct Tile
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+        unsigned int height;
+        uint64_t version;
+    };
+
+    // numThreads = 0 means use all hardware threads
+    explicit ProgressiveEncoder(unsigned int tileSizeInBlocks = 16, unsigned int numThreads = 0);
+    ~ProgressiveEncoder();
+
+    ProgressiveEncoder(const ProgressiveEncoder&) = delete;
+    ProgressiveEncoder& operator=(const ProgressiveEncoder&) = delete;
+
+    // Encode the texture with fastEncoder and start background refinement with slowEncoder
+    // Any refinement in progress is cancelled, the whole texture is published as a single dirty tile
+    // rgba must stay valid until the refinement is finished (see wait/cancel)
+    // slowEncoder is called from several worker threads at once: it must be thread-safe and any lazily initialized
+    // global state (e.g. lookup tables) must be initialized before start
+    // returns fastEncoder result (refinement is not started if it's not zero)
+    int start(const unsigned char* rgba, unsigned int width, unsigned int height, unsigned int stride, CompressFunc fastEncoder, EncodeBlockFunc slowEncoder, void* userData);
+
+    // Stop background refinement (already published tiles are kept)
+    void cancel();
+
+    // Wait until all tiles are refined
+    void wait();
+
+    bool isFinished() const;
+
+    // Version of the last published tile
+    uint64_t getVersion() const;
+
+    // Append tiles published after sinceVersion (in order of publication) and return the current version
+    uint64_t getDirtyTiles(uint64_t sinceVersion, std::vector<Tile>& tiles) const;
+
+    // Copy blocks of the tile, rows of blocks are dstPitch bytes apart
+    void copyTile(const Tile& tile, unsigned char* dst, size_t dstPitch) const;
+
+    // Copy all blocks ((width / 4) * (height / 4) * 8 bytes)
+    void copyBlocks(unsigned char* dst) const;
+
+  private:
+    void refineTiles();
+    void refineTile(unsigned int tileIndex, std::vector<unsigned char>& tileBlocks);
+    void publishTile(const Tile& tile, const unsigned char* tileBlocks);
+
+    const unsigned int tileSize;
+    const unsigned int numThreads;
+
+    // source
+    const unsigned char* source = nullptr;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int stride = 0;
+    EncodeBlockFunc encodeBlock = nullptr;
+    void* encodeBlockUserData = nullptr;
+
+    unsigned int blocksW = 0;
+    unsigned int blocksH = 0;
+    unsigned int tilesW = 0;
+    unsigned int tilesH = 0;
+
+    // compressed blocks and the list of published tiles (protected by mutex)
+    mutable std::mutex mutex;
+    std::vector<unsigned char> blocks;
+    std::vector<Tile> dirtyTiles;
+    uint64_t version = 0;
+
+    std::atomic<unsigned int> nextTile;
+    std::atomic<unsigned int> numRefinedTiles;
+    std::atomic<bool> cancelled;
+    std::vector<std::thread> workers;
+};
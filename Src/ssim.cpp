@@ -0,0 +1,369 @@
+#include "ssim.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SSIM_SSE2 (1)
+#include <emmintrin.h>
+#endif
+
+// -------------------------------------------------------------------------------------------------------------------
+// Image quality assessment: from error visibility to structural similarity
+// Z. Wang, A. C. Bovik, H. R. Sheikh and E. P. Simoncelli, 2004
+//
+// Multi-scale structural similarity for image quality assessment
+// Z. Wang, E. P. Simoncelli and A. C. Bovik, 2003
+// -------------------------------------------------------------------------------------------------------------------
+
+namespace Ssim {
+
+static const int kWindowSize = 11;
+static const float kC1 = (0.01f * 255.0f) * (0.01f * 255.0f);
+static const float kC2 = (0.03f * 255.0f) * (0.03f * 255.0f);
+
+static const int kNumberOfScales = 5;
+static const double kScaleWeights[kNumberOfScales] = { 0.0448, 0.2856, 0.3001, 0.2363, 0.1333 };
+
+struct Plane
+{
+    // not zero-initialized, every pixel is written by the producer
+    std::unique_ptr<float[]> data;
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    void allocate(unsigned int w, unsigned int h)
+    {
+        width = w;
+        height = h;
+        data.reset(new float[size_t(w) * size_t(h)]);
+    }
+
+    const float* row(size_t y) const { return data.get() + y * width; }
+    float* row(size_t y) { return data.get() + y * width; }
+};
+
+struct ScaleSums
+{
+    double ssim = 0.0;
+    double cs = 0.0;
+};
+
+static const float* getGaussianWindow()
+{
+    struct Window
+    {
+        float weights[kWindowSize];
+        Window()
+        {
+            const double sigma = 1.5;
+            double sum = 0.0;
+            for (int i = 0; i < kWindowSize; i++)
+            {
+                const double x = (double)(i - kWindowSize / 2);
+                weights[i] = (float)exp(-(x * x) / (2.0 * sigma * sigma));
+                sum += weights[i];
+            }
+            for (int i = 0; i < kWindowSize; i++)
+            {
+                weights[i] = (float)(weights[i] / sum);
+            }
+        }
+    };
+    static const Window window;
+    return window.weights;
+}
+
+// Y = 0.2126 * R + 0.7152 * G + 0.0722 * B
+static void convertToLuminance(const unsigned char* rgba, unsigned int width, unsigned int height, unsigned int numThreads, Plane& res)
+{
+    res.allocate(width, height);
+    parallelFor(height, numThreads, [&](size_t beginRow, size_t endRow) {
+        for (size_t y = beginRow; y < endRow; y++)
+        {
+            const unsigned char* src = rgba + y * width * 4;
+            float* dst = res.row(y);
+            unsigned int x = 0;
+#ifdef SSIM_SSE2
+            const __m128i byteMask = _mm_set1_epi32(0xff);
+            const __m128 weightR = _mm_set1_ps(0.2126f);
+            const __m128 weightG = _mm_set1_ps(0.7152f);
+            const __m128 weightB = _mm_set1_ps(0.0722f);
+            for (; x + 4 <= width; x += 4)
+            {
+                const __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+                const __m128 r = _mm_cvtepi32_ps(_mm_and_si128(pixels, byteMask));
+                const __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask));
+                const __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask));
+                _mm_storeu_ps(dst + x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(weightR, r), _mm_mul_ps(weightG, g)), _mm_mul_ps(weightB, b)));
+            }
+#endif
+            for (; x < width; x++)
+            {
+                dst[x] = 0.2126f * (float)src[x * 4 + 0] + 0.7152f * (float)src[x * 4 + 1] + 0.0722f * (float)src[x * 4 + 2];
+            }
+        }
+    });
+}
+
+// 2x2 average
+static void downsample(const Plane& src, unsigned int numThreads, Plane& res)
+{
+    res.allocate(src.width / 2, src.height / 2);
+    parallelFor(res.height, numThreads, [&](size_t beginRow, size_t endRow) {
+        for (size_t y = beginRow; y < endRow; y++)
+        {
+            const float* src0 = src.row(y * 2);
+            const float* src1 = src.row(y * 2 + 1);
+            float* dst = res.row(y);
+            for (unsigned int x = 0; x < res.width; x++)
+            {
+                dst[x] = 0.25f * (src0[x * 2] + src0[x * 2 + 1] + src1[x * 2] + src1[x * 2 + 1]);
+            }
+        }
+    });
+}
+
+// Vertical pass of the separable window (for one output row)
+//
+// mu1 = sum(w * x), mu2 = sum(w * y), s11 = sum(w * x * x), s22 = sum(w * y * y), s12 = sum(w * x * y)
+static void filterColumns(const Plane& img1, const Plane& img2, size_t y, const float* weights, float* mu1, float* mu2, float* s11, float* s22, float* s12)
+{
+    const unsigned int width = img1.width;
+    unsigned int x = 0;
+#ifdef SSIM_SSE2
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128 accMu1 = _mm_setzero_ps();
+        __m128 accMu2 = _mm_setzero_ps();
+        __m128 accS11 = _mm_setzero_ps();
+        __m128 accS22 = _mm_setzero_ps();
+        __m128 accS12 = _mm_setzero_ps();
+        for (int k = 0; k < kWindowSize; k++)
+        {
+            const __m128 w = _mm_set1_ps(weights[k]);
+            const __m128 v1 = _mm_loadu_ps(img1.row(y + k) + x);
+            const __m128 v2 = _mm_loadu_ps(img2.row(y + k) + x);
+            const __m128 wv1 = _mm_mul_ps(w, v1);
+            const __m128 wv2 = _mm_mul_ps(w, v2);
+            accMu1 = _mm_add_ps(accMu1, wv1);
+            accMu2 = _mm_add_ps(accMu2, wv2);
+            accS11 = _mm_add_ps(accS11, _mm_mul_ps(wv1, v1));
+            accS22 = _mm_add_ps(accS22, _mm_mul_ps(wv2, v2));
+            accS12 = _mm_add_ps(accS12, _mm_mul_ps(wv1, v2));
+        }
+        _mm_storeu_ps(mu1 + x, accMu1);
+        _mm_storeu_ps(mu2 + x, accMu2);
+        _mm_storeu_ps(s11 + x, accS11);
+        _mm_storeu_ps(s22 + x, accS22);
+        _mm_storeu_ps(s12 + x, accS12);
+    }
+#endif
+    for (; x < width; x++)
+    {
+        float accMu1 = 0.0f;
+        float accMu2 = 0.0f;
+        float accS11 = 0.0f;
+        float accS22 = 0.0f;
+        float accS12 = 0.0f;
+        for (int k = 0; k < kWindowSize; k++)
+        {
+            const float v1 = img1.row(y + k)[x];
+            const float v2 = img2.row(y + k)[x];
+            accMu1 += weights[k] * v1;
+            accMu2 += weights[k] * v2;
+            accS11 += weights[k] * v1 * v1;
+            accS22 += weights[k] * v2 * v2;
+            accS12 += weights[k] * v1 * v2;
+        }
+        mu1[x] = accMu1;
+        mu2[x] = accMu2;
+        s11[x] = accS11;
+        s22[x] = accS22;
+        s12[x] = accS12;
+    }
+}
+
+static inline float filterRow(const float* src, const float* weights)
+{
+    float acc = 0.0f;
+    for (int k = 0; k < kWindowSize; k++)
+    {
+        acc += weights[k] * src[k];
+    }
+    return acc;
+}
+
+// Horizontal pass of the separable window + SSIM map (for one output row)
+static void accumulateSsimRow(unsigned int width, const float* weights, const float* mu1, const float* mu2, const float* s11, const float* s22, const float* s12, ScaleSums& sums)
+{
+    const unsigned int outWidth = width - (kWindowSize - 1);
+    double rowSsim = 0.0;
+    double rowCs = 0.0;
+
+    unsigned int x = 0;
+#ifdef SSIM_SSE2
+    const __m128 c1 = _mm_set1_ps(kC1);
+    const __m128 c2 = _mm_set1_ps(kC2);
+    const __m128 two = _mm_set1_ps(2.0f);
+    __m128 accSsim = _mm_setzero_ps();
+    __m128 accCs = _mm_setzero_ps();
+    for (; x + 4 <= outWidth; x += 4)
+    {
+        __m128 m1 = _mm_setzero_ps();
+        __m128 m2 = _mm_setzero_ps();
+        __m128 e11 = _mm_setzero_ps();
+        __m128 e22 = _mm_setzero_ps();
+        __m128 e12 = _mm_setzero_ps();
+        // the window is symmetric: w[k] * (a[k] + a[10 - k])
+        for (int k = 0; k < kWindowSize / 2; k++)
+        {
+            const __m128 w = _mm_set1_ps(weights[k]);
+            const size_t k0 = x + k;
+            const size_t k1 = x + (kWindowSize - 1) - k;
+            m1 = _mm_add_ps(m1, _mm_mul_ps(w, _mm_add_ps(_mm_loadu_ps(mu1 + k0), _mm_loadu_ps(mu1 + k1))));
+            m2 = _mm_add_ps(m2, _mm_mul_ps(w, _mm_add_ps(_mm_loadu_ps(mu2 + k0), _mm_loadu_ps(mu2 + k1))));
+            e11 = _mm_add_ps(e11, _mm_mul_ps(w, _mm_add_ps(_mm_loadu_ps(s11 + k0), _mm_loadu_ps(s11 + k1))));
+            e22 = _mm_add_ps(e22, _mm_mul_ps(w, _mm_add_ps(_mm_loadu_ps(s22 + k0), _mm_loadu_ps(s22 + k1))));
+            e12 = _mm_add_ps(e12, _mm_mul_ps(w, _mm_add_ps(_mm_loadu_ps(s12 + k0), _mm_loadu_ps(s12 + k1))));
+        }
+        {
+            const int k = kWindowSize / 2;
+            const __m128 w = _mm_set1_ps(weights[k]);
+            m1 = _mm_add_ps(m1, _mm_mul_ps(w, _mm_loadu_ps(mu1 + x + k)));
+            m2 = _mm_add_ps(m2, _mm_mul_ps(w, _mm_loadu_ps(mu2 + x + k)));
+            e11 = _mm_add_ps(e11, _mm_mul_ps(w, _mm_loadu_ps(s11 + x + k)));
+            e22 = _mm_add_ps(e22, _mm_mul_ps(w, _mm_loadu_ps(s22 + x + k)));
+            e12 = _mm_add_ps(e12, _mm_mul_ps(w, _mm_loadu_ps(s12 + x + k)));
+        }
+
+        const __m128 m11 = _mm_mul_ps(m1, m1);
+        const __m128 m22 = _mm_mul_ps(m2, m2);
+        const __m128 m12 = _mm_mul_ps(m1, m2);
+        const __m128 sigma11 = _mm_sub_ps(e11, m11);
+        const __m128 sigma22 = _mm_sub_ps(e22, m22);
+        const __m128 sigma12 = _mm_sub_ps(e12, m12);
+
+        // cs = (2 * sigma12 + C2) / (sigma11 + sigma22 + C2)
+        const __m128 cs = _mm_div_ps(_mm_add_ps(_mm_mul_ps(two, sigma12), c2), _mm_add_ps(_mm_add_ps(sigma11, sigma22), c2));
+        // ssim = (2 * mu1 * mu2 + C1) / (mu1 * mu1 + mu2 * mu2 + C1) * cs
+        const __m128 l = _mm_div_ps(_mm_add_ps(_mm_mul_ps(two, m12), c1), _mm_add_ps(_mm_add_ps(m11, m22), c1));
+        accSsim = _mm_add_ps(accSsim, _mm_mul_ps(l, cs));
+        accCs = _mm_add_ps(accCs, cs);
+    }
+    float lanesSsim[4];
+    float lanesCs[4];
+    _mm_storeu_ps(&lanesSsim[0], accSsim);
+    _mm_storeu_ps(&lanesCs[0], accCs);
+    rowSsim += (double)lanesSsim[0] + (double)lanesSsim[1] + (double)lanesSsim[2] + (double)lanesSsim[3];
+    rowCs += (double)lanesCs[0] + (double)lanesCs[1] + (double)lanesCs[2] + (double)lanesCs[3];
+#endif
+    for (; x < outWidth; x++)
+    {
+        const float m1 = filterRow(mu1 + x, weights);
+        const float m2 = filterRow(mu2 + x, weights);
+        const float sigma11 = filterRow(s11 + x, weights) - m1 * m1;
+        const float sigma22 = filterRow(s22 + x, weights) - m2 * m2;
+        const float sigma12 = filterRow(s12 + x, weights) - m1 * m2;
+        const float cs = (2.0f * sigma12 + kC2) / (sigma11 + sigma22 + kC2);
+        const float l = (2.0f * m1 * m2 + kC1) / (m1 * m1 + m2 * m2 + kC1);
+        rowSsim += (double)(l * cs);
+        rowCs += (double)cs;
+    }
+
+    sums.ssim += rowSsim;
+    sums.cs += rowCs;
+}
+
+// Mean SSIM and mean contrast-structure term of the single scale (valid window positions only)
+static ScaleSums computeScale(const Plane& img1, const Plane& img2, unsigned int numThreads)
+{
+    const float* weights = getGaussianWindow();
+    const size_t outHeight = img1.height - (kWindowSize - 1);
+    const size_t outWidth = img1.width - (kWindowSize - 1);
+
+    ScaleSums sums;
+    std::mutex sumsMutex;
+    parallelFor(outHeight, numThreads, [&](size_t beginRow, size_t endRow) {
+        const size_t width = img1.width;
+        std::vector<float> buffers(width * 5);
+        float* mu1 = &buffers[0];
+        float* mu2 = &buffers[width];
+        float* s11 = &buffers[width * 2];
+        float* s22 = &buffers[width * 3];
+        float* s12 = &buffers[width * 4];
+
+        ScaleSums localSums;
+        for (size_t y = beginRow; y < endRow; y++)
+        {
+            filterColumns(img1, img2, y, weights, mu1, mu2, s11, s22, s12);
+            accumulateSsimRow(img1.width, weights, mu1, mu2, s11, s22, s12, localSums);
+        }
+
+        std::lock_guard<std::mutex> lock(sumsMutex);
+        sums.ssim += localSums.ssim;
+        sums.cs += localSums.cs;
+    });
+
+    const double count = (double)(outWidth * outHeight);
+    sums.ssim /= count;
+    sums.cs /= count;
+    return sums;
+}
+
+SsimResult computeSsim(const unsigned char* rgba1, const unsigned char* rgba2, unsigned int width, unsigned int height, unsigned int numThreads)
+{
+    SsimResult res;
+    res.ssim = 0.0;
+    res.msSsim = 0.0;
+    if (width < (unsigned int)kWindowSize || height < (unsigned int)kWindowSize)
+    {
+        return res;
+    }
+
+    Plane img1;
+    Plane img2;
+    convertToLuminance(rgba1, width, height, numThreads, img1);
+    convertToLuminance(rgba2, width, height, numThreads, img2);
+
+    // MS-SSIM = cs(1)^w1 * cs(2)^w2 * ... * ssim(M)^wM
+    // if the image is too small for all scales, the weights of the used scales are renormalized
+    double logMsSsim = 0.0;
+    double weightsSum = 0.0;
+    for (int scale = 0; scale < kNumberOfScales; scale++)
+    {
+        const ScaleSums sums = computeScale(img1, img2, numThreads);
+        if (scale == 0)
+        {
+            res.ssim = sums.ssim;
+        }
+
+        Plane next1;
+        Plane next2;
+        const bool isLastScale = (scale == (kNumberOfScales - 1)) || (img1.width / 2 < (unsigned int)kWindowSize) || (img1.height / 2 < (unsigned int)kWindowSize);
+
+        // negative values are clamped to zero
+        const double value = std::max(isLastScale ? sums.ssim : sums.cs, 0.0);
+        logMsSsim += kScaleWeights[scale] * log(std::max(value, 1e-12));
+        weightsSum += kScaleWeights[scale];
+        if (isLastScale)
+        {
+            break;
+        }
+
+        downsample(img1, numThreads, next1);
+        downsample(img2, numThreads, next2);
+        img1 = std::move(next1);
+        img2 = std::move(next2);
+    }
+
+    res.msSsim = exp(logMsSsim / weightsSum);
+    return res;
+}
+
+} // namespace Ssim
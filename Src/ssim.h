@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Ssim {
+
+struct SsimResult
+{
+    // mean structural similarity (11x11 gaussian window, sigma = 1.5)
+    double ssim;
+
+    // multi-scale structural similarity (up to 5 scales)
+    double msSsim;
+};
+
+// Compute SSIM and MS-SSIM of the luminance of two RGBA8 images
+// Rows are processed in parallel (numThreads = 0 means use all hardware threads)
+SsimResult computeSsim(const unsigned char* rgba1, const unsigned char* rgba2, unsigned int width, unsigned int height, unsigned int numThreads = 0);
+
+} // namespace Ssim